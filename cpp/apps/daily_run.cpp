@@ -2,8 +2,13 @@
  * @file daily_run.cpp
  * @brief Orchestrator for daily strain index computation.
  *
- * This file executes the computation pipeline in the required order.
- * DO NOT change the execution order.
+ * This file executes the computation pipeline in the required
+ * dataflow order below. The numbering is the dependency contract, not
+ * a serial schedule: after step 4 the graph/diffusion branch (6-10)
+ * and the topology branch (11-16, minus the step 13 save) touch
+ * disjoint data, and --parallel-branches runs them concurrently
+ * without changing any day's numbers. Do not reorder stages within a
+ * branch.
  *
  * Required execution order:
  *   1. read_close_prices_parquet
@@ -20,23 +25,80 @@
  *   12. compute_persistence_H1
  *   13. save_diagram_bin
  *   14. compute_total_persistence
- *   15. load_diagram_bin (previous day)
+ *   15. load previous diagram (strain_history.bin offset lookup, with
+ *       date-by-date filesystem probing as fallback for old trees)
  *   16. compute_wasserstein_distance
  *   17. compute_strain_index
  *   18. write_strain_json
+ *
+ * Modes:
+ *   Single-day (default):
+ *     --input data/compute_inputs/prices_window_YYYY-MM-DD.parquet
+ *     One parquet window per invocation, full correlation recompute.
+ *     With --masked-input the window may be the raw warehouse export:
+ *     null prices become masked cells, returns are masked where either
+ *     endpoint price is missing, and the correlation is estimated
+ *     pairwise-complete (--masked-min-obs sets the floor below which a
+ *     pair's correlation is 0). Steps 5-18 are unchanged.
+ *
+ *   Batch (backfill):
+ *     --batch-input <tall_prices.parquet> --batch-dates <dates.txt>
+ *     One tall [T x N] price matrix covering the whole range, with one
+ *     YYYY-MM-DD date per price row in dates.txt. The rolling window
+ *     slides forward one day at a time and the correlation is updated
+ *     incrementally (rank-1 downdate/update of X^T X) instead of being
+ *     recomputed from scratch per day. Steps 3-18 run per day exactly
+ *     as in single-day mode.
+ *
+ *   Preview (coarse sector graph):
+ *     --input <prices_window.parquet> --preview-sectors <mapping.csv>
+ *     Computes full-resolution returns and correlation (steps 1-5),
+ *     then aggregates the correlation into a K x K sector block matrix
+ *     (K ~ 50) and runs the identical downstream pipeline (steps 6-18)
+ *     on the coarse graph. Artifacts land under <output>/preview/ so
+ *     full-resolution runs are unchanged; Wasserstein compares against
+ *     the previous preview diagram. Intended as a fast approximate
+ *     strain read while the full run is still in flight.
+ *
+ *   Serve (resident):
+ *     --serve <socket_path>
+ *     Stays resident listening on a Unix-domain socket and processes
+ *     newline-delimited requests, keeping the workspace buffers warm
+ *     across requests so intraday polling avoids process startup,
+ *     Arrow initialization, and cold allocations. Protocol:
+ *       RUN <parquet_path> [YYYY-MM-DD]  -> "OK <date> <strain_index>"
+ *       PING                             -> "PONG"
+ *       SHUTDOWN                         -> "BYE" (server exits)
+ *     Errors are reported as "ERR <message>" without killing the server.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <csignal>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <regex>
+#include <sstream>
 #include <stdexcept>
 #include <vector>
 
 #include <iostream>
 #include <string>
 
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <exception>
+#include <memory>
+#include <thread>
+
 #include "types.hpp"
+#include "io_async.hpp"
+#include "io_cache.hpp"
 #include "io_parquet.hpp"
 #include "returns.hpp"
 #include "correlation.hpp"
@@ -44,6 +106,11 @@
 #include "diffusion.hpp"
 #include "topology.hpp"
 #include "strain.hpp"
+#include "preview.hpp"
+#include "workspace.hpp"
+#include "numa.hpp"
+#include "io_history.hpp"
+#include "perf.hpp"
 
 static std::string get_env_or_empty(const char* name) {
     const char* value = std::getenv(name);
@@ -139,13 +206,6 @@ static std::string find_previous_diagram_path(
     return std::string();
 }
 
-static double parse_double_or_default(const std::string& text, double default_value) {
-    if (text.empty()) {
-        return default_value;
-    }
-    return std::stod(text);
-}
-
 static std::string parse_required_arg(int argc, char* argv[], const std::string& name) {
     for (int i = 1; i + 1 < argc; ++i) {
         if (argv[i] == name) {
@@ -173,6 +233,15 @@ static double parse_optional_double_arg(int argc, char* argv[], const std::strin
     return default_value;
 }
 
+static int parse_optional_int_arg(int argc, char* argv[], const std::string& name, int default_value) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (argv[i] == name) {
+            return std::stoi(std::string(argv[i + 1]));
+        }
+    }
+    return default_value;
+}
+
 static double compute_normalized_strain_index(double strain_index, double mean, double std_pop) {
     if (std::isnan(strain_index) || std::isinf(strain_index)) {
         throw std::runtime_error("strain_index must be finite for normalization");
@@ -194,131 +263,580 @@ static double l2_norm(const Vector& values) {
     return std::sqrt(sum_squares);
 }
 
-int main(int argc, char* argv[]) {
-    const std::string parquet_input_path = parse_required_arg(argc, argv, "--input");
-    const std::string output_root = parse_optional_arg(argc, argv, "--output", "out/daily");
+/**
+ * @brief Run-level configuration shared by single-day and batch modes.
+ */
+struct DailyRunConfig {
+    std::string output_root;
+    double diffusion_eta;
+    double coefficient_a;
+    double coefficient_b;
+    double coefficient_c;
+    double coefficient_d;
+    double coefficient_e;
+    double strain_mean;
+    double strain_std_pop;
+    /// Sparse graph mode: keep edges with weight > threshold. 0 keeps the
+    /// fully dense graph (historical behavior).
+    double graph_weight_threshold;
+    /// Sparse graph mode: keep top-k neighbors per asset. 0 disables.
+    int graph_top_k;
+    /// Filtration cutoff for H1 persistence: 0 = auto enclosing radius,
+    /// > 0 explicit, < 0 full (uncapped) filtration.
+    double persistence_distance_threshold;
+    /// Approximate Wasserstein: prune pairs with lifetime below this
+    /// epsilon before matching. 0 keeps every pair (exact default).
+    double wasserstein_lifetime_epsilon;
+    /// Approximate Wasserstein: hera auction relative error (delta).
+    /// 0 keeps hera's exact default.
+    double wasserstein_relative_error;
+    /// Persist/reuse the Laplacian eigendecomposition as spectral.bin in
+    /// the day's output directory, keyed by a hash of the Laplacian.
+    bool use_spectral_cache;
+    /// Packed-symmetric mode (--packed 1): store W and the distance
+    /// matrix as strictly-lower triangles (half the memory) and hand
+    /// the packed float distances to Ripser by move with no extraction
+    /// copy. Applies to the dense double path only; sparse and float32
+    /// modes keep their own layouts.
+    bool use_packed_symmetric;
+    /// Overlap the binary artifact writes (returns.bin, corr.bin,
+    /// diagram.bin) with the following compute stages on a background
+    /// I/O thread. Writes are joined before any artifact is read back
+    /// and before process exit.
+    bool use_async_io;
+    /// Run the graph/diffusion branch (steps 6-10) and the topology
+    /// branch (steps 11-16) concurrently (--parallel-branches). The
+    /// branches read only the correlation and meet again at the strain
+    /// formula, so the day's numbers are unchanged.
+    bool use_parallel_branches;
+    /// Normalize the strain index against persistent Welford moments
+    /// (<output_root>/normalization_state.bin), updated O(1) per day
+    /// (--online-normalization), instead of the pinned --strain-mean /
+    /// --strain-std-pop constants.
+    bool use_online_normalization;
+    /// Masked ingest (--masked-input): read the raw warehouse parquet
+    /// with a per-cell validity mask (nulls and non-finite prices become
+    /// missing cells instead of a hard error) and estimate correlations
+    /// pairwise-complete over the rows where both assets are observed.
+    /// Single-day and serve modes only; batch mode keeps the pre-cleaned
+    /// input contract.
+    bool use_masked_input;
+    /// Masked ingest: minimum pairwise-complete observations for a
+    /// correlation estimate; pairs below this get correlation 0.
+    uint32_t masked_minimum_observations;
+    /// Incremental persistence: warm-start the H1 filtration cap from
+    /// the previous day's diagram (with full-run fallback when the cap
+    /// clips a class). Only applies when persistence_distance_threshold
+    /// is 0 (auto); an explicit threshold wins.
+    bool use_incremental_persistence;
+    /// Relative headroom above the previous max death for the warm cap.
+    double incremental_persistence_margin;
+    /// Preview mode: path to a ticker,sector mapping CSV. When set,
+    /// single-day mode aggregates the correlation to K x K sector
+    /// blocks and runs steps 6-18 on the coarse graph, writing under
+    /// <output_root>/preview/. Empty disables (full resolution).
+    std::string preview_sector_mapping_path;
+    /// Run the O(N^2) graph and distance stages in single precision
+    /// (--precision float32). Diffusion and the strain arithmetic stay
+    /// in double; Ripser narrows to float internally either way.
+    bool use_float32_precision;
 
-    std::string run_date = parse_optional_arg(argc, argv, "--date", "");
-    if (run_date.empty()) {
-        const std::string run_date_env = get_env_or_empty("RUN_DATE");
-        if (!run_date_env.empty()) {
-            run_date = run_date_env;
-        } else {
-            const std::string inferred = infer_run_date_from_input_or_empty(parquet_input_path);
-            run_date = inferred.empty() ? today_new_york_date_string() : inferred;
-        }
+    bool use_sparse_graph() const {
+        return graph_weight_threshold > 0.0 || graph_top_k > 0;
     }
+};
 
-    const double diffusion_eta = parse_optional_double_arg(argc, argv, "--eta", 1.0);
-    const double coefficient_a = parse_optional_double_arg(argc, argv, "--a", 1.0);
-    const double coefficient_b = parse_optional_double_arg(argc, argv, "--b", 1.0);
-    const double coefficient_c = parse_optional_double_arg(argc, argv, "--c", 1.0);
-    const double coefficient_d = parse_optional_double_arg(argc, argv, "--d", 1.0);
-    const double coefficient_e = parse_optional_double_arg(argc, argv, "--e", 1.0);
+/**
+ * @brief Fault the day's N x N workspace buffers with parallel first
+ *        touch before the stages run.
+ *
+ * The stage-internal resize calls then find the capacity already
+ * present, with pages placed under the same static thread partitioning
+ * the row-parallel kernels use (see numa.hpp). Cheap no-op after the
+ * first day of a batch. The packed distance buffer is excluded: it is
+ * moved into Ripser each day and reallocates by design.
+ */
+static void prewarm_workspace_first_touch(
+    Workspace& workspace,
+    uint32_t number_of_assets,
+    const DailyRunConfig& config
+) {
+    const size_t matrix_element_count =
+        static_cast<size_t>(number_of_assets) * number_of_assets;
 
-    // Normalization parameters (defaults from contracts/params.md for current calibration run)
-    const double strain_mean = parse_optional_double_arg(argc, argv, "--strain-mean", 14.998030683897552);
-    const double strain_std_pop = parse_optional_double_arg(argc, argv, "--strain-std-pop", 3.134706030763302);
+    first_touch_resize(workspace.correlation, matrix_element_count);
+    if (config.use_float32_precision) {
+        first_touch_resize(workspace.correlation_f, matrix_element_count);
+        first_touch_resize(workspace.graph_f, matrix_element_count);
+        first_touch_resize(workspace.distance_f, matrix_element_count);
+    } else if (config.use_packed_symmetric) {
+        first_touch_resize(
+            workspace.correlation_packed,
+            packed_lower_entry_count(number_of_assets));
+        first_touch_resize(
+            workspace.graph_packed,
+            packed_lower_entry_count(number_of_assets));
+        // The packed path still densifies the Laplacian for diffusion.
+        first_touch_resize(workspace.graph, matrix_element_count);
+    } else if (!config.use_sparse_graph()) {
+        first_touch_resize(workspace.graph, matrix_element_count);
+        first_touch_resize(workspace.distance, matrix_element_count);
+    }
+}
 
-    const std::string output_dir = join_path(output_root, "date=" + run_date);
+/**
+ * @brief Execute steps 3-18 of the pipeline for one day.
+ *
+ * Callers provide the return window, latest return vector, and the
+ * correlation matrix for the day (computed either from scratch or via
+ * an incremental rolling update in batch mode). Scratch N x N buffers
+ * live in the workspace so batch runs reuse one set of allocations
+ * across all days.
+ *
+ * @return The (unnormalized) strain index for the day.
+ */
+static double run_pipeline_for_day(
+    const Matrix& window_returns,
+    const Vector& latest_return,
+    const Matrix& correlation,
+    uint32_t number_of_assets,
+    uint32_t rolling_window_length,
+    const std::string& run_date,
+    Workspace& workspace,
+    PerfReport& perf_report,
+    AsyncArtifactWriter* async_writer,
+    const DailyRunConfig& config
+) {
+    perf_report.date = run_date;
+    perf_report.number_of_assets = number_of_assets;
+    perf_report.window_length = rolling_window_length;
+    const std::string output_dir = join_path(config.output_root, "date=" + run_date);
     std::filesystem::create_directories(std::filesystem::path(output_dir));
 
     const std::string returns_bin_path = join_path(output_dir, "returns.bin");
     const std::string corr_bin_path = join_path(output_dir, "corr.bin");
     const std::string diagram_bin_path = join_path(output_dir, "diagram.bin");
     const std::string strain_json_path = join_path(output_dir, "strain.json");
+    const std::string perf_json_path = join_path(output_dir, "perf.json");
 
-    // 1) read_close_prices_parquet
-    uint32_t number_of_price_rows = 0;
-    uint32_t number_of_assets = 0;
-    Matrix closing_prices = read_close_prices_parquet(
-        parquet_input_path,
-        number_of_price_rows,
-        number_of_assets
-    );
+    // Appendable history files at the output root (preview runs get
+    // their own pair under <output>/preview/).
+    const std::string history_path = join_path(config.output_root, "strain_history.bin");
+    const std::string diagram_log_path = join_path(config.output_root, "diagrams.bin");
 
-    if (number_of_price_rows < 2) {
-        throw std::runtime_error("prices_window.parquet must contain at least 2 price rows");
+    {
+        ScopedStageTimer timer(perf_report, "save_input_artifacts");
+
+        if (async_writer != nullptr) {
+            // Hand copies to the background writer so the graph stages
+            // start immediately; both buffers are still read by later
+            // stages, and a memcpy is cheap next to the actual write.
+
+            // 3) save_returns_bin
+            async_writer->enqueue_returns_bin(
+                window_returns, number_of_assets, rolling_window_length, returns_bin_path);
+
+            // 5) save_correlation_matrix_bin
+            async_writer->enqueue_correlation_bin(correlation, number_of_assets, corr_bin_path);
+        } else {
+            // 3) save_returns_bin
+            save_returns_bin(window_returns, number_of_assets, rolling_window_length, returns_bin_path);
+
+            // 5) save_correlation_matrix_bin
+            save_correlation_bin(correlation, number_of_assets, corr_bin_path);
+        }
     }
 
-    const uint32_t rolling_window_length = number_of_price_rows - 1;
-    if (rolling_window_length != 50) {
-        std::cerr
-            << "WARNING: rolling_window_length expected 50 returns, got "
-            << rolling_window_length
-            << std::endl;
+    // Shared precision conversions, hoisted ahead of the branch fork:
+    // both the graph branch (6-10) and the topology branch (11-16)
+    // read these buffers, so they must exist before the branches can
+    // run concurrently.
+    if (config.use_float32_precision) {
+        workspace.correlation_f.assign(correlation.begin(), correlation.end());
+    } else if (config.use_packed_symmetric) {
+        pack_lower_into(correlation, number_of_assets, workspace.correlation_packed);
     }
 
-    // 2) compute_log_returns
-    Returns returns = compute_log_returns(closing_prices, number_of_assets, rolling_window_length);
+    // 6-10) graph branch: graph construction, Laplacian, GTV,
+    // diffusion, systemic ratio; dense by default, sparse (CSR) when a
+    // threshold or top-k cutoff is set. Expressed as a callable so
+    // --parallel-branches can overlap it with the topology branch.
+    double graph_total_variation = 0.0;
+    Vector smoothed_return;
+    double systemic_ratio = 0.0;
 
-    // 3) save_returns_bin
-    save_returns_bin(returns.window_returns, number_of_assets, rolling_window_length, returns_bin_path);
+    const auto run_graph_branch = [&]() {
+    if (config.use_sparse_graph()) {
+        // 6) build_weighted_adjacency_matrix (thresholded, sparse)
+        SparseMatrixCSR weighted_adjacency;
+        {
+            ScopedStageTimer timer(perf_report, "build_weighted_graph");
+            weighted_adjacency = build_weighted_graph_sparse(
+                correlation,
+                number_of_assets,
+                config.graph_weight_threshold,
+                static_cast<uint32_t>(config.graph_top_k)
+            );
+        }
 
-    // 4) compute_correlation
-    Matrix correlation = compute_correlation(returns.window_returns, number_of_assets, rolling_window_length);
+        // 7) compute_graph_laplacian
+        SparseMatrixCSR laplacian;
+        {
+            ScopedStageTimer timer(perf_report, "compute_laplacian");
+            laplacian = compute_laplacian_sparse(weighted_adjacency, number_of_assets);
+        }
 
-    // 5) save_correlation_matrix_bin
-    save_correlation_bin(correlation, number_of_assets, corr_bin_path);
+        // 8) compute_graph_total_variation
+        {
+            ScopedStageTimer timer(perf_report, "compute_graph_total_variation");
+            graph_total_variation = compute_graph_total_variation_sparse(
+                latest_return,
+                laplacian,
+                number_of_assets
+            );
+        }
 
-    // 6) build_weighted_adjacency_matrix
-    Matrix weighted_adjacency = build_weighted_graph(correlation, number_of_assets);
+        // 9) diffuse_return_vectors (matrix-free expmv)
+        {
+            ScopedStageTimer timer(perf_report, "diffuse_returns");
+            smoothed_return = diffuse_returns_sparse(
+                laplacian,
+                latest_return,
+                number_of_assets,
+                config.diffusion_eta
+            );
+        }
+    } else {
+        if (config.use_float32_precision) {
+            // 6-8) single-precision graph stages: half the memory
+            // traffic on the three O(N^2) kernels (the correlation was
+            // narrowed before the fork). The Laplacian is widened back
+            // to double once for the diffusion eigensolver.
+            VectorF latest_return_f(latest_return.begin(), latest_return.end());
 
-    // 7) compute_graph_laplacian
-    Matrix laplacian = compute_laplacian(weighted_adjacency, number_of_assets);
+            {
+                ScopedStageTimer timer(perf_report, "build_weighted_graph");
+                build_weighted_graph_into(
+                    workspace.correlation_f, number_of_assets, workspace.graph_f);
+            }
+            {
+                ScopedStageTimer timer(perf_report, "compute_laplacian");
+                compute_laplacian_in_place(workspace.graph_f, number_of_assets);
+            }
+            {
+                ScopedStageTimer timer(perf_report, "compute_graph_total_variation");
+                graph_total_variation = compute_graph_total_variation(
+                    latest_return_f,
+                    workspace.graph_f,
+                    number_of_assets
+                );
+            }
 
-    // 8) compute_graph_total_variation
-    const double graph_total_variation = compute_graph_total_variation(
-        returns.latest_return,
-        laplacian,
-        number_of_assets
-    );
+            workspace.graph.assign(workspace.graph_f.begin(), workspace.graph_f.end());
+        } else if (config.use_packed_symmetric) {
+            // 6-8) packed strictly-lower graph stages: W lives as
+            // N*(N-1)/2 entries and the Laplacian is emitted dense for
+            // the diffusion eigensolver without ever materializing a
+            // dense W.
+            {
+                ScopedStageTimer timer(perf_report, "build_weighted_graph");
+                build_weighted_graph_packed_into(
+                    workspace.correlation_packed, number_of_assets, workspace.graph_packed);
+            }
+            {
+                ScopedStageTimer timer(perf_report, "compute_laplacian");
+                compute_laplacian_from_packed_into(
+                    workspace.graph_packed, number_of_assets, workspace.graph);
+            }
+            {
+                ScopedStageTimer timer(perf_report, "compute_graph_total_variation");
+                graph_total_variation = compute_graph_total_variation_packed(
+                    latest_return,
+                    workspace.graph_packed,
+                    number_of_assets
+                );
+            }
+        } else {
+            // 6) build_weighted_adjacency_matrix (into the reusable buffer)
+            // 7) compute_graph_laplacian (in place: W is dead once L exists)
+            {
+                ScopedStageTimer timer(perf_report, "build_weighted_graph");
+                build_weighted_graph_into(correlation, number_of_assets, workspace.graph);
+            }
+            {
+                ScopedStageTimer timer(perf_report, "compute_laplacian");
+                compute_laplacian_in_place(workspace.graph, number_of_assets);
+            }
 
-    // 9) diffuse_return_vectors
-    Vector smoothed_return = diffuse_returns(laplacian, returns.latest_return, number_of_assets, diffusion_eta);
+            // 8) compute_graph_total_variation
+            {
+                ScopedStageTimer timer(perf_report, "compute_graph_total_variation");
+                graph_total_variation = compute_graph_total_variation(
+                    latest_return,
+                    workspace.graph,
+                    number_of_assets
+                );
+            }
+        }
 
-    // 10) compute_systemic_ratio
-    const double systemic_ratio = compute_systemic_ratio(smoothed_return, returns.latest_return);
+        const Matrix& laplacian = workspace.graph;
 
-    // 11) convert_correlation_to_distance
-    Matrix distance_matrix = correlation_to_distance(correlation, number_of_assets);
+        // 9) diffuse_return_vectors
+        ScopedStageTimer timer(perf_report, "diffuse_returns");
+        if (config.use_spectral_cache) {
+            // Reuse the persisted eigendecomposition when the Laplacian
+            // is byte-identical to the one it was computed from (e.g. a
+            // re-run after a downstream write failure).
+            const std::string spectral_bin_path = join_path(output_dir, "spectral.bin");
+            const uint64_t laplacian_hash = compute_bytes_hash_fnv1a(
+                laplacian.data(),
+                laplacian.size() * sizeof(double)
+            );
 
-    // 12) compute_persistent_homology_H1
-    PersistenceDiagram diagram = compute_persistence_H1(distance_matrix, number_of_assets);
+            SpectralDecomposition decomposition;
+            bool loaded_from_cache = false;
+            if (file_exists(spectral_bin_path)) {
+                try {
+                    uint32_t cached_assets = 0;
+                    uint64_t cached_hash = 0;
+                    SpectralDecomposition cached =
+                        load_spectral_cache_bin(spectral_bin_path, cached_assets, cached_hash);
+                    if (cached_assets == number_of_assets && cached_hash == laplacian_hash) {
+                        decomposition = std::move(cached);
+                        loaded_from_cache = true;
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "WARNING: ignoring unreadable spectral cache: "
+                              << e.what() << std::endl;
+                }
+            }
 
-    // 13) save_persistence_diagram_bin
-    save_diagram_bin(diagram, diagram_bin_path);
+            if (!loaded_from_cache) {
+                decomposition = compute_spectral_decomposition(laplacian, number_of_assets);
+                save_spectral_cache_bin(
+                    decomposition,
+                    number_of_assets,
+                    laplacian_hash,
+                    spectral_bin_path
+                );
+            }
 
-    // 14) compute_total_persistence
-    const double total_persistence = compute_total_persistence(diagram);
+            smoothed_return = diffuse_returns_with_decomposition(
+                decomposition,
+                latest_return,
+                number_of_assets,
+                config.diffusion_eta
+            );
+        } else {
+            smoothed_return = diffuse_returns(laplacian, latest_return, number_of_assets, config.diffusion_eta);
+        }
+    }
 
-    // 15) load_previous_persistence_diagram
-    const std::string previous_diagram_path = find_previous_diagram_path(output_root, run_date, 7);
+    // 10) compute_systemic_ratio
+    systemic_ratio = compute_systemic_ratio(smoothed_return, latest_return);
+    };
+
+    // 11-12, 15) topology branch: previous diagram lookup, distance
+    // conversion, and the Ripser reduction. Reads only the correlation
+    // (in its hoisted precision form) and the history files, so it is
+    // independent of the graph branch above and can overlap it under
+    // --parallel-branches. Times against the caller-chosen report so
+    // the overlapped run never appends to perf_report from two threads.
     PersistenceDiagram previous_diagram;
     bool has_previous_diagram = false;
-    if (!previous_diagram_path.empty()) {
-        previous_diagram = load_diagram_bin(previous_diagram_path);
+    PersistenceDiagram diagram;
+
+    const auto run_topology_branch = [&](PerfReport& branch_perf) {
+    // Join any in-flight writes before reading artifacts back: in batch
+    // mode yesterday's diagram.bin may still be queued on the I/O
+    // thread. Also surfaces background write failures for this day.
+    if (async_writer != nullptr) {
+        async_writer->wait_for_pending();
+    }
+
+    // 15) load_previous_persistence_diagram — loaded here (a pure read;
+    // no compute stage is reordered) because incremental persistence
+    // warm-starts step 12 from yesterday's diagram. The Wasserstein
+    // step below reuses this load. The strain history gives the
+    // previous diagram's offset in one read; date-by-date filesystem
+    // probing remains as the fallback for output trees that predate the
+    // history file. Both honor the same 7-day staleness bound.
+    StrainHistoryRecord previous_record;
+    if (find_latest_history_record_before(history_path, run_date, previous_record) &&
+        previous_record.diagram_byte_count > 0 &&
+        std::string(previous_record.date) >=
+            decrement_date_string_by_days(run_date, 7)) {
+        previous_diagram = read_diagram_log_at(
+            diagram_log_path,
+            previous_record.diagram_offset,
+            previous_record.diagram_byte_count);
         has_previous_diagram = true;
+    } else {
+        const std::string previous_diagram_path =
+            find_previous_diagram_path(config.output_root, run_date, 7);
+        if (!previous_diagram_path.empty()) {
+            previous_diagram = load_diagram_bin(previous_diagram_path);
+            has_previous_diagram = true;
+        }
     }
 
-    // 16) compute_wasserstein_distance
-    const double wasserstein_distance = has_previous_diagram
-        ? compute_wasserstein_distance(diagram, previous_diagram)
-        : 0.0;
+    // Warm start only applies on the auto (enclosing radius) cutoff; an
+    // explicit --persistence-threshold wins.
+    const bool warm_start_persistence =
+        config.use_incremental_persistence &&
+        has_previous_diagram &&
+        config.persistence_distance_threshold == 0.0;
+
+    // 11) convert_correlation_to_distance (into the reusable buffer)
+    // 12) compute_persistent_homology_H1
+    // In float32 mode the distance matrix stays single precision end to
+    // end: Ripser narrows to float internally anyway.
+    if (config.use_float32_precision) {
+        {
+            ScopedStageTimer timer(branch_perf, "correlation_to_distance");
+            correlation_to_distance_into(
+                workspace.correlation_f, number_of_assets, workspace.distance_f);
+        }
+        {
+            ScopedStageTimer timer(branch_perf, "compute_persistence_H1");
+            if (warm_start_persistence) {
+                diagram = compute_persistence_H1_warm_start(
+                    workspace.distance_f,
+                    number_of_assets,
+                    previous_diagram,
+                    config.incremental_persistence_margin
+                );
+            } else {
+                diagram = compute_persistence_H1(
+                    workspace.distance_f,
+                    number_of_assets,
+                    config.persistence_distance_threshold
+                );
+            }
+        }
+    } else if (config.use_packed_symmetric) {
+        {
+            ScopedStageTimer timer(branch_perf, "correlation_to_distance");
+            correlation_to_distance_packed_into(
+                workspace.correlation_packed, number_of_assets, workspace.distance_packed);
+        }
+        {
+            ScopedStageTimer timer(branch_perf, "compute_persistence_H1");
+            // The packed buffer is moved into Ripser (zero-copy), so a
+            // warm-start fallback rerun could not reuse it; packed mode
+            // always runs the configured threshold directly.
+            diagram = compute_persistence_H1_packed(
+                std::move(workspace.distance_packed),
+                number_of_assets,
+                config.persistence_distance_threshold
+            );
+        }
+    } else {
+        {
+            ScopedStageTimer timer(branch_perf, "correlation_to_distance");
+            correlation_to_distance_into(correlation, number_of_assets, workspace.distance);
+        }
+        {
+            ScopedStageTimer timer(branch_perf, "compute_persistence_H1");
+            if (warm_start_persistence) {
+                diagram = compute_persistence_H1_warm_start(
+                    workspace.distance,
+                    number_of_assets,
+                    previous_diagram,
+                    config.incremental_persistence_margin
+                );
+            } else {
+                diagram = compute_persistence_H1(
+                    workspace.distance,
+                    number_of_assets,
+                    config.persistence_distance_threshold
+                );
+            }
+        }
+    }
+    };
+
+    if (config.use_parallel_branches) {
+        // Overlap the two slowest stages: the eigendecomposition inside
+        // diffuse_returns and the Ripser reduction in
+        // compute_persistence_H1 work on different data and meet again
+        // only at the strain formula (step 17).
+        PerfReport topology_perf;
+        std::exception_ptr topology_failure;
+        std::thread topology_thread([&]() {
+            try {
+                run_topology_branch(topology_perf);
+            } catch (...) {
+                topology_failure = std::current_exception();
+            }
+        });
+        try {
+            run_graph_branch();
+        } catch (...) {
+            topology_thread.join();
+            throw;
+        }
+        topology_thread.join();
+        if (topology_failure) {
+            std::rethrow_exception(topology_failure);
+        }
+        // One stage list for the day: the overlapped stages report
+        // their own wall times, appended after the graph branch's.
+        for (const StageTiming& stage : topology_perf.stages) {
+            perf_report.stages.push_back(stage);
+        }
+    } else {
+        run_graph_branch();
+        run_topology_branch(perf_report);
+    }
+
+    perf_report.diagram_pair_count = static_cast<uint32_t>(diagram.size());
+
+    // 13) save_persistence_diagram_bin (the diagram is still read by
+    // steps 14 and 16, so the background writer gets a copy)
+    if (async_writer != nullptr) {
+        async_writer->enqueue_diagram_bin(diagram, diagram_bin_path);
+    } else {
+        save_diagram_bin(diagram, diagram_bin_path);
+    }
+
+    // Also append the diagram to the consolidated log. Synchronous even
+    // with the background writer: appends to the shared log must stay
+    // in day order, and the record is tiny next to the N x N artifacts.
+    uint64_t diagram_log_byte_count = 0;
+    const uint64_t diagram_log_offset =
+        append_diagram_log(diagram_log_path, diagram, diagram_log_byte_count);
+
+    // 14) compute_total_persistence
+    const double total_persistence = compute_total_persistence(diagram);
+
+    // 16) compute_wasserstein_distance (previous diagram loaded above)
+    double wasserstein_distance = 0.0;
+    {
+        ScopedStageTimer timer(perf_report, "compute_wasserstein_distance");
+        if (has_previous_diagram) {
+            wasserstein_distance = compute_wasserstein_distance(
+                diagram,
+                previous_diagram,
+                config.wasserstein_lifetime_epsilon,
+                config.wasserstein_relative_error
+            );
+        }
+    }
 
     // 17) compute_strain_index
-    const double l2_return_magnitude = l2_norm(returns.latest_return);
+    const double l2_return_magnitude = l2_norm(latest_return);
     const double strain_index = compute_strain_index(
         l2_return_magnitude,
         graph_total_variation,
         systemic_ratio,
         wasserstein_distance,
         total_persistence,
-        coefficient_a,
-        coefficient_e,
-        coefficient_b,
-        coefficient_c,
-        coefficient_d
+        config.coefficient_a,
+        config.coefficient_e,
+        config.coefficient_b,
+        config.coefficient_c,
+        config.coefficient_d
     );
 
     // 18) write_strain_json
@@ -330,13 +848,823 @@ int main(int argc, char* argv[]) {
     components.total_persistence = total_persistence;
     components.wasserstein_distance = wasserstein_distance;
     components.strain_index = strain_index;
-    components.normalized_strain_index = compute_normalized_strain_index(
-        strain_index,
-        strain_mean,
-        strain_std_pop
-    );
+    if (config.use_online_normalization) {
+        // Self-maintaining z-score: fold today's strain into the
+        // persistent Welford moments (O(1); re-runs of a counted day
+        // are skipped) and normalize against the updated state. The
+        // pinned CLI constants stay in effect until the state has
+        // enough history for a positive variance.
+        const std::string normalization_state_path =
+            join_path(config.output_root, "normalization_state.bin");
+        NormalizationState normalization_state =
+            load_normalization_state_bin(normalization_state_path);
+        update_normalization_state(normalization_state, strain_index, run_date);
+        save_normalization_state_bin(normalization_state, normalization_state_path);
+
+        const double online_std_pop = normalization_state_std_pop(normalization_state);
+        if (online_std_pop > 0.0) {
+            components.normalized_strain_index = compute_normalized_strain_index(
+                strain_index,
+                normalization_state.mean,
+                online_std_pop
+            );
+        } else {
+            components.normalized_strain_index = compute_normalized_strain_index(
+                strain_index,
+                config.strain_mean,
+                config.strain_std_pop
+            );
+        }
+    } else {
+        components.normalized_strain_index = compute_normalized_strain_index(
+            strain_index,
+            config.strain_mean,
+            config.strain_std_pop
+        );
+    }
 
     write_strain_json(components, strain_json_path);
 
+    // One fixed-size history row per day alongside the JSON, carrying
+    // the diagram's offset in the consolidated log.
+    append_strain_history(
+        history_path, components, diagram_log_offset, diagram_log_byte_count);
+
+    // Performance sidecar: stage latencies and problem sizes for this
+    // day, next to strain.json so dashboards can trend them together.
+    write_perf_json(perf_report, perf_json_path);
+
+    return strain_index;
+}
+
+/**
+ * @brief Read the batch dates file: one YYYY-MM-DD per price row.
+ */
+static std::vector<std::string> read_batch_dates(const std::string& dates_path) {
+    std::ifstream input_file(dates_path);
+    if (!input_file.is_open()) {
+        throw std::runtime_error("Failed to open batch dates file: " + dates_path);
+    }
+
+    std::vector<std::string> dates;
+    std::string line;
+    while (std::getline(input_file, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        dates.push_back(line);
+    }
+
+    if (dates.empty()) {
+        throw std::runtime_error("batch dates file is empty: " + dates_path);
+    }
+
+    return dates;
+}
+
+/**
+ * @brief Process one parquet window end to end (steps 1-18).
+ *
+ * Shared by single-day mode and the resident serve mode. The caller
+ * owns the workspace and returns buffers, so a resident server keeps
+ * them warm across requests instead of reallocating per invocation.
+ *
+ * @return The (unnormalized) strain index for the day.
+ */
+static double run_single_input(
+    const std::string& parquet_input_path,
+    const std::string& run_date,
+    Workspace& workspace,
+    Returns& returns,
+    AsyncArtifactWriter* async_writer,
+    const DailyRunConfig& config
+) {
+    PerfReport perf_report;
+
+    // 1) read_close_prices_parquet (masked ingest keeps the same stage
+    //    name: it is the same read, plus a validity mask)
+    uint32_t number_of_price_rows = 0;
+    uint32_t number_of_assets = 0;
+    Matrix closing_prices;
+    ValidityMask price_valid;
+    {
+        ScopedStageTimer timer(perf_report, "read_close_prices_parquet");
+        if (config.use_masked_input) {
+            closing_prices = read_close_prices_parquet_masked(
+                parquet_input_path,
+                number_of_price_rows,
+                number_of_assets,
+                price_valid
+            );
+        } else {
+            closing_prices = read_close_prices_parquet(
+                parquet_input_path,
+                number_of_price_rows,
+                number_of_assets
+            );
+        }
+    }
+
+    if (number_of_price_rows < 2) {
+        throw std::runtime_error("prices_window.parquet must contain at least 2 price rows");
+    }
+
+    const uint32_t rolling_window_length = number_of_price_rows - 1;
+    if (rolling_window_length != 50) {
+        std::cerr
+            << "WARNING: rolling_window_length expected 50 returns, got "
+            << rolling_window_length
+            << std::endl;
+    }
+
+    prewarm_workspace_first_touch(workspace, number_of_assets, config);
+
+    // 2) compute_log_returns
+    ValidityMask return_valid;
+    {
+        ScopedStageTimer timer(perf_report, "compute_log_returns");
+        if (config.use_masked_input) {
+            compute_log_returns_masked_into(
+                closing_prices,
+                price_valid,
+                number_of_assets,
+                rolling_window_length,
+                returns,
+                return_valid
+            );
+        } else {
+            compute_log_returns_into(
+                closing_prices, number_of_assets, rolling_window_length, returns);
+        }
+    }
+
+    // 4) compute_correlation (pairwise-complete under masked ingest;
+    //    the masked latest_return carries 0.0 at missing cells and the
+    //    correlation keeps its unit diagonal, so steps 5-18 run
+    //    unchanged on the masked estimate)
+    {
+        ScopedStageTimer timer(perf_report, "compute_correlation");
+        if (config.use_masked_input) {
+            std::vector<uint32_t> effective_observations;
+            compute_correlation_masked_into(
+                returns.window_returns,
+                return_valid,
+                number_of_assets,
+                rolling_window_length,
+                config.masked_minimum_observations,
+                workspace.correlation,
+                effective_observations
+            );
+
+            size_t missing_return_cells = 0;
+            for (uint8_t cell_valid : return_valid) {
+                missing_return_cells += (cell_valid == 0) ? 1 : 0;
+            }
+            uint32_t minimum_pairwise_count = rolling_window_length;
+            for (uint32_t i = 0; i < number_of_assets; ++i) {
+                for (uint32_t j = i + 1; j < number_of_assets; ++j) {
+                    const uint32_t pair_count = effective_observations[
+                        static_cast<size_t>(i) * number_of_assets + j];
+                    minimum_pairwise_count =
+                        std::min(minimum_pairwise_count, pair_count);
+                }
+            }
+            std::cerr
+                << "Masked ingest: " << missing_return_cells << " / "
+                << return_valid.size() << " return cells missing, minimum "
+                << "pairwise observations " << minimum_pairwise_count
+                << " (floor " << config.masked_minimum_observations << ")"
+                << std::endl;
+        } else {
+            compute_correlation_into(
+                returns.window_returns,
+                number_of_assets,
+                rolling_window_length,
+                workspace.correlation
+            );
+        }
+    }
+
+    // 3, 5-18
+    const double strain_index = run_pipeline_for_day(
+        returns.window_returns,
+        returns.latest_return,
+        workspace.correlation,
+        number_of_assets,
+        rolling_window_length,
+        run_date,
+        workspace,
+        perf_report,
+        async_writer,
+        config
+    );
+
+    // One day per invocation: join the day's writes before reporting
+    // success so failures surface here, not at process exit.
+    if (async_writer != nullptr) {
+        async_writer->wait_for_pending();
+    }
+
+    return strain_index;
+}
+
+/**
+ * @brief Preview mode: coarse sector-graph strain for one parquet window.
+ *
+ * Runs steps 1-5 at full resolution, aggregates the correlation matrix
+ * and return rows into K sector blocks via the ticker-to-sector mapping,
+ * then runs steps 6-18 unchanged on the K x K problem. With K ~ 50 the
+ * cubic stages (graph, diffusion, Ripser) are effectively free, giving
+ * an approximate strain read orders of magnitude faster than the full
+ * run. Artifacts go under <output_root>/preview/date=..., keeping the
+ * full-resolution outputs (and their diagram history) untouched; the
+ * Wasserstein term compares consecutive preview diagrams, which live on
+ * the same coarse scale.
+ *
+ * @return The (unnormalized) preview strain index for the day.
+ */
+static double run_preview_input(
+    const std::string& parquet_input_path,
+    const std::string& run_date,
+    const DailyRunConfig& config
+) {
+    PerfReport perf_report;
+
+    if (config.use_masked_input) {
+        std::cerr
+            << "WARNING: --masked-input is ignored in preview mode "
+            << "(sector aggregation reads the pre-cleaned window)"
+            << std::endl;
+    }
+
+    // 1) read_close_prices_parquet (+ column tickers for the mapping)
+    uint32_t number_of_price_rows = 0;
+    uint32_t number_of_assets = 0;
+    Matrix closing_prices;
+    std::vector<std::string> tickers;
+    {
+        ScopedStageTimer timer(perf_report, "read_close_prices_parquet");
+        closing_prices = read_close_prices_parquet(
+            parquet_input_path,
+            number_of_price_rows,
+            number_of_assets
+        );
+        tickers = read_close_prices_column_names(parquet_input_path);
+    }
+
+    if (number_of_price_rows < 2) {
+        throw std::runtime_error("prices_window.parquet must contain at least 2 price rows");
+    }
+    if (tickers.size() != number_of_assets) {
+        throw std::runtime_error("parquet column name count does not match price column count");
+    }
+
+    const uint32_t rolling_window_length = number_of_price_rows - 1;
+
+    Workspace workspace;
+    Returns returns;
+
+    // 2) compute_log_returns
+    {
+        ScopedStageTimer timer(perf_report, "compute_log_returns");
+        compute_log_returns_into(closing_prices, number_of_assets, rolling_window_length, returns);
+    }
+
+    // 4) compute_correlation (full resolution: the aggregation averages
+    // asset-level correlations, not sector-level return series)
+    {
+        ScopedStageTimer timer(perf_report, "compute_correlation");
+        compute_correlation_into(
+            returns.window_returns,
+            number_of_assets,
+            rolling_window_length,
+            workspace.correlation
+        );
+    }
+
+    // Aggregate correlation, latest return, and the return window down
+    // to sector blocks.
+    const SectorMapping mapping =
+        load_sector_mapping_csv(config.preview_sector_mapping_path, tickers);
+    const uint32_t number_of_sectors = mapping.number_of_sectors;
+
+    Matrix sector_correlation;
+    Vector sector_latest_return;
+    Matrix sector_window_returns(
+        static_cast<size_t>(rolling_window_length) * number_of_sectors);
+    {
+        ScopedStageTimer timer(perf_report, "aggregate_by_sector");
+        sector_correlation = aggregate_correlation_by_sector(
+            workspace.correlation, number_of_assets, mapping);
+        sector_latest_return = aggregate_vector_by_sector(
+            returns.latest_return, number_of_assets, mapping);
+
+        Vector window_row(number_of_assets);
+        for (uint32_t row = 0; row < rolling_window_length; ++row) {
+            std::copy(
+                returns.window_returns.begin() + static_cast<size_t>(row) * number_of_assets,
+                returns.window_returns.begin() + static_cast<size_t>(row + 1) * number_of_assets,
+                window_row.begin()
+            );
+            const Vector sector_row =
+                aggregate_vector_by_sector(window_row, number_of_assets, mapping);
+            std::copy(
+                sector_row.begin(),
+                sector_row.end(),
+                sector_window_returns.begin() + static_cast<size_t>(row) * number_of_sectors
+            );
+        }
+    }
+
+    std::cout
+        << "PREVIEW aggregated " << number_of_assets << " assets into "
+        << number_of_sectors << " sectors" << std::endl;
+
+    // 3, 5-18 on the coarse graph, under a preview-specific output root
+    // so full-resolution artifacts and diagram history stay untouched.
+    DailyRunConfig preview_config = config;
+    preview_config.output_root = join_path(config.output_root, "preview");
+
+    // Preview artifacts are K-sized (kilobytes); synchronous writes are
+    // already negligible, so no async writer here.
+    Workspace preview_workspace;
+    return run_pipeline_for_day(
+        sector_window_returns,
+        sector_latest_return,
+        sector_correlation,
+        number_of_sectors,
+        rolling_window_length,
+        run_date,
+        preview_workspace,
+        perf_report,
+        nullptr,
+        preview_config
+    );
+}
+
+static std::string resolve_run_date(const std::string& parquet_input_path, const std::string& requested_date) {
+    if (!requested_date.empty()) {
+        return requested_date;
+    }
+    const std::string run_date_env = get_env_or_empty("RUN_DATE");
+    if (!run_date_env.empty()) {
+        return run_date_env;
+    }
+    const std::string inferred = infer_run_date_from_input_or_empty(parquet_input_path);
+    return inferred.empty() ? today_new_york_date_string() : inferred;
+}
+
+static int run_single_day(int argc, char* argv[], const DailyRunConfig& config) {
+    const std::string parquet_input_path = parse_required_arg(argc, argv, "--input");
+    const std::string run_date = resolve_run_date(
+        parquet_input_path,
+        parse_optional_arg(argc, argv, "--date", "")
+    );
+
+    if (!config.preview_sector_mapping_path.empty()) {
+        run_preview_input(parquet_input_path, run_date, config);
+        return 0;
+    }
+
+    Workspace workspace;
+    Returns returns;
+    std::unique_ptr<AsyncArtifactWriter> async_writer;
+    if (config.use_async_io) {
+        async_writer = std::make_unique<AsyncArtifactWriter>();
+    }
+    run_single_input(parquet_input_path, run_date, workspace, returns, async_writer.get(), config);
+
+    return 0;
+}
+
+/**
+ * @brief Handle one serve-mode request line; see the protocol in the
+ *        file header. Compute failures are reported to the client as
+ *        "ERR <message>" instead of terminating the server.
+ */
+static std::string handle_serve_request(
+    const std::string& request_line,
+    Workspace& workspace,
+    Returns& returns,
+    AsyncArtifactWriter* async_writer,
+    const DailyRunConfig& config,
+    bool& shutdown_requested
+) {
+    std::istringstream fields(request_line);
+    std::string command;
+    fields >> command;
+
+    if (command.empty()) {
+        return "ERR empty request";
+    }
+    if (command == "PING") {
+        return "PONG";
+    }
+    if (command == "SHUTDOWN") {
+        shutdown_requested = true;
+        return "BYE";
+    }
+    if (command == "RUN") {
+        std::string parquet_path;
+        std::string requested_date;
+        fields >> parquet_path >> requested_date;
+        if (parquet_path.empty()) {
+            return "ERR RUN requires a parquet path";
+        }
+
+        try {
+            const std::string run_date = resolve_run_date(parquet_path, requested_date);
+            const double strain_index =
+                run_single_input(parquet_path, run_date, workspace, returns, async_writer, config);
+
+            std::ostringstream reply;
+            reply << std::setprecision(17) << "OK " << run_date << " " << strain_index;
+            return reply.str();
+        } catch (const std::exception& e) {
+            return std::string("ERR ") + e.what();
+        }
+    }
+
+    return "ERR unknown command: " + command;
+}
+
+/**
+ * @brief Write a full reply to a client, reporting failure instead of
+ *        throwing.
+ *
+ * A client may disconnect before reading its reply; that must cost the
+ * client its connection, never the resident server. MSG_NOSIGNAL keeps
+ * the kernel from raising SIGPIPE on the closed peer (SIGPIPE is also
+ * ignored process-wide in run_serve as a second line of defense).
+ *
+ * @return true if every byte was written, false on any write error.
+ */
+static bool write_all_to_client(int file_descriptor, const std::string& data) {
+    size_t total_written = 0;
+    while (total_written < data.size()) {
+        const ssize_t written = send(
+            file_descriptor,
+            data.data() + total_written,
+            data.size() - total_written,
+            MSG_NOSIGNAL
+        );
+        if (written <= 0) {
+            return false;
+        }
+        total_written += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * @brief Resident compute-server mode (--serve <socket_path>).
+ *
+ * Listens on a Unix-domain socket and processes requests without
+ * restarting the process: the workspace and returns buffers stay warm
+ * across requests, so intraday polling pays only the per-window
+ * compute instead of startup plus cold allocation each tick.
+ */
+static int run_serve(int argc, char* argv[], const DailyRunConfig& config) {
+    const std::string socket_path = parse_required_arg(argc, argv, "--serve");
+
+    // A client that disconnects mid-reply must not kill the daemon: the
+    // default SIGPIPE disposition terminates the process.
+    signal(SIGPIPE, SIG_IGN);
+
+    const int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        throw std::runtime_error("Failed to create Unix-domain socket");
+    }
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        close(listen_fd);
+        throw std::runtime_error("Socket path too long: " + socket_path);
+    }
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    // Replace a stale socket from a previous server instance.
+    unlink(socket_path.c_str());
+
+    if (bind(listen_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close(listen_fd);
+        throw std::runtime_error("Failed to bind socket: " + socket_path);
+    }
+    if (listen(listen_fd, 4) != 0) {
+        close(listen_fd);
+        throw std::runtime_error("Failed to listen on socket: " + socket_path);
+    }
+
+    // Warm state: lives for the whole server lifetime so repeated
+    // requests reuse hot buffers (and the OS page cache for sidecars).
+    Workspace workspace;
+    Returns returns;
+    std::unique_ptr<AsyncArtifactWriter> async_writer;
+    if (config.use_async_io) {
+        async_writer = std::make_unique<AsyncArtifactWriter>();
+    }
+
+    std::cout << "SERVE listening on " << socket_path << std::endl;
+
+    bool shutdown_requested = false;
+    while (!shutdown_requested) {
+        const int client_fd = accept(listen_fd, nullptr, nullptr);
+        if (client_fd < 0) {
+            continue;
+        }
+
+        std::string buffered_input;
+        char chunk[4096];
+        ssize_t bytes_read = 0;
+        bool client_alive = true;
+
+        while (client_alive && !shutdown_requested &&
+               (bytes_read = read(client_fd, chunk, sizeof(chunk))) > 0) {
+            buffered_input.append(chunk, static_cast<size_t>(bytes_read));
+
+            size_t newline_position = 0;
+            while ((newline_position = buffered_input.find('\n')) != std::string::npos) {
+                const std::string request_line = buffered_input.substr(0, newline_position);
+                buffered_input.erase(0, newline_position + 1);
+
+                const std::string reply = handle_serve_request(
+                    request_line, workspace, returns, async_writer.get(), config, shutdown_requested);
+                if (!write_all_to_client(client_fd, reply + "\n")) {
+                    // Connection-local failure (client went away): drop
+                    // this client and keep serving. SHUTDOWN still
+                    // honors the request even if its BYE was unread.
+                    std::cerr << "SERVE client write failed; closing connection" << std::endl;
+                    client_alive = false;
+                    break;
+                }
+
+                if (shutdown_requested) {
+                    break;
+                }
+            }
+        }
+
+        close(client_fd);
+    }
+
+    close(listen_fd);
+    unlink(socket_path.c_str());
+    std::cout << "SERVE stopped" << std::endl;
     return 0;
 }
+
+static int run_batch(int argc, char* argv[], const DailyRunConfig& config) {
+    if (config.use_masked_input) {
+        // The rolling Gram updates assume every window row is observed;
+        // a per-pair effective count cannot be rolled as a rank-1
+        // update. Backfills keep the pre-cleaned input contract.
+        std::cerr
+            << "WARNING: --masked-input is ignored in batch mode "
+            << "(incremental Gram rolling requires complete rows)"
+            << std::endl;
+    }
+    const std::string batch_input_path = parse_required_arg(argc, argv, "--batch-input");
+    const std::string batch_dates_path = parse_required_arg(argc, argv, "--batch-dates");
+    const std::string start_date = parse_optional_arg(argc, argv, "--start-date", "");
+    const std::string end_date = parse_optional_arg(argc, argv, "--end-date", "");
+    const int rolling_window_length =
+        parse_optional_int_arg(argc, argv, "--window", 50);
+
+    if (rolling_window_length < 2) {
+        throw std::runtime_error("--window must be at least 2");
+    }
+
+    // Read the tall [T x N] price matrix once for the whole range.
+    uint32_t number_of_price_rows = 0;
+    uint32_t number_of_assets = 0;
+    Matrix closing_prices = read_close_prices_parquet(
+        batch_input_path,
+        number_of_price_rows,
+        number_of_assets
+    );
+
+    const std::vector<std::string> price_row_dates = read_batch_dates(batch_dates_path);
+    if (price_row_dates.size() != number_of_price_rows) {
+        throw std::runtime_error(
+            "batch dates count mismatch: file has " + std::to_string(price_row_dates.size()) +
+            " dates, parquet has " + std::to_string(number_of_price_rows) + " price rows"
+        );
+    }
+
+    const uint32_t window_length = static_cast<uint32_t>(rolling_window_length);
+    if (number_of_price_rows < window_length + 1) {
+        throw std::runtime_error(
+            "batch input must contain at least window + 1 price rows, got " +
+            std::to_string(number_of_price_rows)
+        );
+    }
+
+    // Compute log returns over the whole tall matrix once; return row k
+    // covers price rows k -> k+1.
+    const uint32_t total_return_days = number_of_price_rows - 1;
+    Returns all_returns = compute_log_returns(closing_prices, number_of_assets, total_return_days);
+
+    // Seed the rolling Gram matrix from the first full window. The
+    // workspace buffers are faulted once with parallel first touch and
+    // reused for every day.
+    Workspace workspace;
+    prewarm_workspace_first_touch(workspace, number_of_assets, config);
+    Matrix& window_returns = workspace.window_returns;
+    first_touch_resize(
+        window_returns, static_cast<size_t>(window_length) * number_of_assets);
+    std::copy(
+        all_returns.window_returns.begin(),
+        all_returns.window_returns.begin() + window_returns.size(),
+        window_returns.begin()
+    );
+
+    RollingCorrelationState rolling_state =
+        init_rolling_correlation(window_returns, number_of_assets, window_length);
+
+    Vector latest_return(number_of_assets);
+    Vector outgoing_returns(number_of_assets);
+    Vector incoming_returns(number_of_assets);
+
+    // One background writer for the whole backfill: day t's artifact
+    // writes overlap day t+1's compute (run_pipeline_for_day joins
+    // before it reads yesterday's diagram back).
+    std::unique_ptr<AsyncArtifactWriter> async_writer;
+    if (config.use_async_io) {
+        async_writer = std::make_unique<AsyncArtifactWriter>();
+    }
+
+    int days_processed = 0;
+
+    // Price row index t is the "latest" day of its window; its window
+    // covers return rows [t - window, t).
+    for (uint32_t t = window_length; t < number_of_price_rows; ++t) {
+        const std::string& run_date = price_row_dates[t];
+
+        const bool in_range =
+            (start_date.empty() || run_date >= start_date) &&
+            (end_date.empty() || run_date <= end_date);
+
+        if (in_range) {
+            const size_t window_start_row = static_cast<size_t>(t - window_length);
+            std::copy(
+                all_returns.window_returns.begin() + window_start_row * number_of_assets,
+                all_returns.window_returns.begin() + (window_start_row + window_length) * number_of_assets,
+                window_returns.begin()
+            );
+
+            const size_t latest_row_start = static_cast<size_t>(t - 1) * number_of_assets;
+            std::copy(
+                all_returns.window_returns.begin() + latest_row_start,
+                all_returns.window_returns.begin() + latest_row_start + number_of_assets,
+                latest_return.begin()
+            );
+
+            PerfReport perf_report;
+
+            // 4) compute_correlation (incremental: rolled Gram matrix,
+            // written into the reusable workspace buffer)
+            {
+                ScopedStageTimer timer(perf_report, "compute_correlation");
+                correlation_from_rolling_state_into(rolling_state, workspace.correlation);
+            }
+
+            run_pipeline_for_day(
+                window_returns,
+                latest_return,
+                workspace.correlation,
+                number_of_assets,
+                window_length,
+                run_date,
+                workspace,
+                perf_report,
+                async_writer.get(),
+                config
+            );
+
+            days_processed += 1;
+            std::cout << "BATCH " << run_date << " done" << std::endl;
+        }
+
+        // Slide the window forward by one day for the next iteration.
+        if (t + 1 < number_of_price_rows) {
+            const size_t outgoing_row_start = static_cast<size_t>(t - window_length) * number_of_assets;
+            const size_t incoming_row_start = static_cast<size_t>(t) * number_of_assets;
+            std::copy(
+                all_returns.window_returns.begin() + outgoing_row_start,
+                all_returns.window_returns.begin() + outgoing_row_start + number_of_assets,
+                outgoing_returns.begin()
+            );
+            std::copy(
+                all_returns.window_returns.begin() + incoming_row_start,
+                all_returns.window_returns.begin() + incoming_row_start + number_of_assets,
+                incoming_returns.begin()
+            );
+            roll_correlation_window(rolling_state, outgoing_returns, incoming_returns);
+        }
+    }
+
+    // Join the last day's writes before declaring the backfill done.
+    if (async_writer) {
+        async_writer->wait_for_pending();
+    }
+
+    std::cout << "BATCH complete: " << days_processed << " day(s) processed" << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    DailyRunConfig config;
+    config.output_root = parse_optional_arg(argc, argv, "--output", "out/daily");
+    config.diffusion_eta = parse_optional_double_arg(argc, argv, "--eta", 1.0);
+    config.coefficient_a = parse_optional_double_arg(argc, argv, "--a", 1.0);
+    config.coefficient_b = parse_optional_double_arg(argc, argv, "--b", 1.0);
+    config.coefficient_c = parse_optional_double_arg(argc, argv, "--c", 1.0);
+    config.coefficient_d = parse_optional_double_arg(argc, argv, "--d", 1.0);
+    config.coefficient_e = parse_optional_double_arg(argc, argv, "--e", 1.0);
+
+    // Normalization parameters (defaults from contracts/params.md for current calibration run)
+    config.strain_mean = parse_optional_double_arg(argc, argv, "--strain-mean", 14.998030683897552);
+    config.strain_std_pop = parse_optional_double_arg(argc, argv, "--strain-std-pop", 3.134706030763302);
+
+    // Sparse graph mode (default: dense, as before)
+    config.graph_weight_threshold = parse_optional_double_arg(argc, argv, "--graph-threshold", 0.0);
+    config.graph_top_k = parse_optional_int_arg(argc, argv, "--graph-top-k", 0);
+    config.persistence_distance_threshold =
+        parse_optional_double_arg(argc, argv, "--persistence-threshold", 0.0);
+
+    // Packed symmetric storage (default: off, dense N x N as before)
+    config.use_packed_symmetric =
+        parse_optional_int_arg(argc, argv, "--packed", 0) != 0;
+
+    // Async artifact I/O (default: off, synchronous writes as before)
+    config.use_async_io =
+        parse_optional_int_arg(argc, argv, "--async-io", 0) != 0;
+
+    // Parallel branch execution (default: off, sequential as before)
+    config.use_parallel_branches =
+        parse_optional_int_arg(argc, argv, "--parallel-branches", 0) != 0;
+
+    // Online normalization (default: off, pinned constants as before)
+    config.use_online_normalization =
+        parse_optional_int_arg(argc, argv, "--online-normalization", 0) != 0;
+
+    // Masked ingest (default: off, pre-cleaned input contract as before)
+    config.use_masked_input =
+        parse_optional_int_arg(argc, argv, "--masked-input", 0) != 0;
+    const int masked_min_obs =
+        parse_optional_int_arg(argc, argv, "--masked-min-obs", 10);
+    if (masked_min_obs < 2) {
+        std::cerr << "ERROR: --masked-min-obs must be >= 2, got "
+                  << masked_min_obs << std::endl;
+        return 1;
+    }
+    config.masked_minimum_observations = static_cast<uint32_t>(masked_min_obs);
+
+    // Incremental persistence (default: off, full reduction as before)
+    config.use_incremental_persistence =
+        parse_optional_int_arg(argc, argv, "--incremental-persistence", 0) != 0;
+    config.incremental_persistence_margin =
+        parse_optional_double_arg(argc, argv, "--incremental-margin", 0.25);
+
+    // Approximate Wasserstein mode (default: exact, as before)
+    config.wasserstein_lifetime_epsilon =
+        parse_optional_double_arg(argc, argv, "--wasserstein-epsilon", 0.0);
+    config.wasserstein_relative_error =
+        parse_optional_double_arg(argc, argv, "--wasserstein-delta", 0.0);
+    config.use_spectral_cache =
+        parse_optional_int_arg(argc, argv, "--spectral-cache", 0) != 0;
+
+    // Preview mode (default: off, full resolution as before)
+    config.preview_sector_mapping_path =
+        parse_optional_arg(argc, argv, "--preview-sectors", "");
+
+    // NUMA pinning (default: off). Must run before the first parallel
+    // region so OpenMP workers inherit the affinity mask.
+    const int numa_node = parse_optional_int_arg(argc, argv, "--numa-node", -1);
+    if (numa_node >= 0) {
+        const uint32_t pinned_cpu_count =
+            pin_threads_to_numa_node(static_cast<uint32_t>(numa_node));
+        std::cout << "NUMA pinned to node " << numa_node
+                  << " (" << pinned_cpu_count << " CPUs)" << std::endl;
+    }
+
+    // Compute precision (default: float64, as before)
+    const std::string precision = parse_optional_arg(argc, argv, "--precision", "float64");
+    if (precision != "float64" && precision != "float32") {
+        std::cerr << "ERROR: --precision must be float64 or float32, got " << precision << std::endl;
+        return 1;
+    }
+    config.use_float32_precision = (precision == "float32");
+
+    const std::string serve_socket = parse_optional_arg(argc, argv, "--serve", "");
+    if (!serve_socket.empty()) {
+        return run_serve(argc, argv, config);
+    }
+
+    const std::string batch_input = parse_optional_arg(argc, argv, "--batch-input", "");
+    if (!batch_input.empty()) {
+        return run_batch(argc, argv, config);
+    }
+    return run_single_day(argc, argv, config);
+}
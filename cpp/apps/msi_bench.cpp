@@ -0,0 +1,547 @@
+/**
+ * @file msi_bench.cpp
+ * @brief Per-stage benchmark suite for the msi_core library.
+ *
+ * Purpose:
+ *   Measure each library stage in isolation on synthetic correlated
+ *   universes so optimizations can be evaluated without hand-timing
+ *   daily_run end to end. Reports ns/op, an effective GB/s derived
+ *   from the bytes each stage touches, and heap allocations per op.
+ *
+ * Stages benchmarked:
+ *   compute_correlation, build_weighted_graph, compute_laplacian,
+ *   compute_graph_total_variation, diffuse_returns,
+ *   correlation_to_distance, compute_persistence_H1,
+ *   compute_wasserstein_distance
+ *
+ * Usage:
+ *   ./msi_bench [--sizes 500,1000,3000] [--window 50]
+ *               [--min-time-ms 200] [--skip-topology]
+ *               [--save-baseline <file>] [--compare-baseline <file>]
+ *               [--regression-tolerance 0.10]
+ *
+ * Baseline mode:
+ *   --save-baseline writes one "stage N ns_per_op" line per result.
+ *   --compare-baseline reloads such a file and prints the ratio of
+ *   current to baseline ns/op per stage; the process exits nonzero if
+ *   any stage regressed by more than the tolerance, so the suite can
+ *   gate CI before a slowdown reaches the nightly job.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+#include "correlation.hpp"
+#include "graph.hpp"
+#include "diffusion.hpp"
+#include "topology.hpp"
+
+// -----------------------------------------------------------------------------
+// Allocation counting
+// -----------------------------------------------------------------------------
+
+// Global new/delete overrides local to this executable. The counter is
+// atomic because the benchmarked stages allocate from OpenMP worker
+// threads (Eigen temporaries, per-thread buffers); relaxed ordering is
+// enough for a pure count.
+static std::atomic<size_t> g_allocation_count{0};
+
+void* operator new(size_t size) {
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    void* pointer = std::malloc(size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+// -----------------------------------------------------------------------------
+// Synthetic universe generation
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Generate a synthetic correlated return window [m x N].
+ *
+ * Three-factor model: r_{t,i} = sum_k B_{ik} f_{t,k} + eps_{t,i}, which
+ * produces a correlation matrix with realistic block structure instead
+ * of pure noise. Deterministic for a given (N, m, seed).
+ */
+static Matrix generate_synthetic_returns(
+    uint32_t number_of_assets,
+    uint32_t window_length,
+    uint32_t seed
+) {
+    const uint32_t number_of_factors = 3;
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+
+    std::vector<double> factor_loadings(
+        static_cast<size_t>(number_of_assets) * number_of_factors
+    );
+    for (double& loading : factor_loadings) {
+        loading = 0.5 * normal(rng);
+    }
+
+    Matrix returns(static_cast<size_t>(window_length) * number_of_assets);
+    std::vector<double> factor_returns(number_of_factors);
+
+    for (uint32_t t = 0; t < window_length; ++t) {
+        for (uint32_t k = 0; k < number_of_factors; ++k) {
+            factor_returns[k] = 0.01 * normal(rng);
+        }
+        for (uint32_t i = 0; i < number_of_assets; ++i) {
+            double value = 0.005 * normal(rng);
+            for (uint32_t k = 0; k < number_of_factors; ++k) {
+                value += factor_loadings[
+                    static_cast<size_t>(i) * number_of_factors + k
+                ] * factor_returns[k];
+            }
+            returns[static_cast<size_t>(t) * number_of_assets + i] = value;
+        }
+    }
+
+    return returns;
+}
+
+// -----------------------------------------------------------------------------
+// Benchmark harness
+// -----------------------------------------------------------------------------
+
+struct BenchResult {
+    std::string stage_name;
+    uint32_t number_of_assets;
+    uint32_t repetitions;
+    double nanoseconds_per_op;
+    double gigabytes_per_second;
+    double allocations_per_op;
+};
+
+/**
+ * @brief Time a stage until the minimum wall-time budget is spent.
+ *
+ * Runs the workload once to warm caches (and to size the repetition
+ * count), then loops until at least min_time_ms has elapsed. The
+ * effective bandwidth is bytes_touched_per_op / time_per_op.
+ */
+template <typename Workload>
+static BenchResult run_benchmark(
+    const std::string& stage_name,
+    uint32_t number_of_assets,
+    size_t bytes_touched_per_op,
+    double min_time_ms,
+    Workload&& workload
+) {
+    using Clock = std::chrono::steady_clock;
+
+    // Warm-up run (also primes any lazily sized buffers).
+    workload();
+
+    uint32_t repetitions = 0;
+    const size_t allocations_before =
+        g_allocation_count.load(std::memory_order_relaxed);
+    const Clock::time_point start_time = Clock::now();
+    double elapsed_ms = 0.0;
+
+    do {
+        workload();
+        repetitions += 1;
+        elapsed_ms = std::chrono::duration<double, std::milli>(
+            Clock::now() - start_time
+        ).count();
+    } while (elapsed_ms < min_time_ms);
+
+    const size_t allocations =
+        g_allocation_count.load(std::memory_order_relaxed) - allocations_before;
+
+    BenchResult result;
+    result.stage_name = stage_name;
+    result.number_of_assets = number_of_assets;
+    result.repetitions = repetitions;
+    result.nanoseconds_per_op = (elapsed_ms * 1e6) / repetitions;
+    result.gigabytes_per_second =
+        static_cast<double>(bytes_touched_per_op) / result.nanoseconds_per_op;
+    result.allocations_per_op =
+        static_cast<double>(allocations) / repetitions;
+    return result;
+}
+
+static void print_result(const BenchResult& result) {
+    std::cout << std::left << std::setw(30) << result.stage_name
+              << " N=" << std::setw(6) << result.number_of_assets
+              << " reps=" << std::setw(6) << result.repetitions
+              << " ns/op=" << std::setw(14) << std::fixed << std::setprecision(0)
+              << result.nanoseconds_per_op
+              << " GB/s=" << std::setw(8) << std::setprecision(2)
+              << result.gigabytes_per_second
+              << " allocs/op=" << std::setprecision(1)
+              << result.allocations_per_op
+              << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+// Baseline save / compare
+// -----------------------------------------------------------------------------
+
+static std::string baseline_key(const BenchResult& result) {
+    return result.stage_name + " " + std::to_string(result.number_of_assets);
+}
+
+static void save_baseline(
+    const std::vector<BenchResult>& results,
+    const std::string& output_path
+) {
+    std::ofstream output_file(output_path);
+    if (!output_file.is_open()) {
+        throw std::runtime_error("Failed to open baseline for writing: " + output_path);
+    }
+    for (const BenchResult& result : results) {
+        output_file << baseline_key(result) << " "
+                    << std::setprecision(17) << result.nanoseconds_per_op << "\n";
+    }
+    if (!output_file.good()) {
+        throw std::runtime_error("Error writing baseline file: " + output_path);
+    }
+}
+
+static std::map<std::string, double> load_baseline(const std::string& input_path) {
+    std::ifstream input_file(input_path);
+    if (!input_file.is_open()) {
+        throw std::runtime_error("Failed to open baseline for reading: " + input_path);
+    }
+
+    std::map<std::string, double> baseline;
+    std::string line;
+    while (std::getline(input_file, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string stage_name;
+        std::string assets_text;
+        double nanoseconds_per_op = 0.0;
+        if (!(fields >> stage_name >> assets_text >> nanoseconds_per_op)) {
+            throw std::runtime_error("Malformed baseline line: " + line);
+        }
+        baseline[stage_name + " " + assets_text] = nanoseconds_per_op;
+    }
+    return baseline;
+}
+
+/**
+ * @brief Print per-stage ratios against a baseline.
+ *
+ * @return Number of stages that regressed beyond the tolerance.
+ */
+static int compare_against_baseline(
+    const std::vector<BenchResult>& results,
+    const std::map<std::string, double>& baseline,
+    double regression_tolerance
+) {
+    int regressions = 0;
+
+    std::cout << std::endl << "Baseline comparison (current / baseline):" << std::endl;
+    for (const BenchResult& result : results) {
+        const auto entry = baseline.find(baseline_key(result));
+        if (entry == baseline.end()) {
+            std::cout << "  " << baseline_key(result)
+                      << "  (not in baseline)" << std::endl;
+            continue;
+        }
+
+        const double ratio = result.nanoseconds_per_op / entry->second;
+        const bool regressed = ratio > 1.0 + regression_tolerance;
+        if (regressed) {
+            regressions += 1;
+        }
+
+        std::cout << "  " << std::left << std::setw(38) << baseline_key(result)
+                  << std::fixed << std::setprecision(3) << ratio
+                  << (regressed ? "  REGRESSION" : "")
+                  << std::endl;
+    }
+
+    return regressions;
+}
+
+// -----------------------------------------------------------------------------
+// Argument parsing (same hand-rolled style as daily_run)
+// -----------------------------------------------------------------------------
+
+static std::string parse_optional_arg(int argc, char* argv[], const std::string& name, const std::string& default_value) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (argv[i] == name) {
+            return std::string(argv[i + 1]);
+        }
+    }
+    return default_value;
+}
+
+static double parse_optional_double_arg(int argc, char* argv[], const std::string& name, double default_value) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (argv[i] == name) {
+            return std::stod(std::string(argv[i + 1]));
+        }
+    }
+    return default_value;
+}
+
+static int parse_optional_int_arg(int argc, char* argv[], const std::string& name, int default_value) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (argv[i] == name) {
+            return std::stoi(std::string(argv[i + 1]));
+        }
+    }
+    return default_value;
+}
+
+static bool has_flag(int argc, char* argv[], const std::string& name) {
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i] == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::vector<uint32_t> parse_sizes(const std::string& sizes_text) {
+    std::vector<uint32_t> sizes;
+    std::istringstream fields(sizes_text);
+    std::string token;
+    while (std::getline(fields, token, ',')) {
+        const int value = std::stoi(token);
+        if (value < 2) {
+            throw std::runtime_error("--sizes entries must be >= 2");
+        }
+        sizes.push_back(static_cast<uint32_t>(value));
+    }
+    if (sizes.empty()) {
+        throw std::runtime_error("--sizes must contain at least one universe size");
+    }
+    return sizes;
+}
+
+// -----------------------------------------------------------------------------
+// Per-universe benchmark run
+// -----------------------------------------------------------------------------
+
+static void benchmark_universe(
+    uint32_t number_of_assets,
+    uint32_t window_length,
+    double min_time_ms,
+    bool skip_topology,
+    std::vector<BenchResult>& results
+) {
+    const size_t matrix_bytes =
+        static_cast<size_t>(number_of_assets) * number_of_assets * sizeof(double);
+
+    const Matrix window_returns =
+        generate_synthetic_returns(number_of_assets, window_length, 1234 + number_of_assets);
+
+    Vector latest_return(number_of_assets);
+    std::copy(
+        window_returns.end() - number_of_assets,
+        window_returns.end(),
+        latest_return.begin()
+    );
+
+    // Fixed inputs for each stage, computed once outside the timed loops.
+    // Every stage writes into a reusable workspace buffer so the reported
+    // allocation counts reflect the kernels, not the harness.
+    Matrix correlation =
+        compute_correlation(window_returns, number_of_assets, window_length);
+    Matrix weighted_adjacency = build_weighted_graph(correlation, number_of_assets);
+    Matrix laplacian = compute_laplacian(weighted_adjacency, number_of_assets);
+    Matrix distance_matrix = correlation_to_distance(correlation, number_of_assets);
+
+    Matrix scratch_matrix;
+    volatile double sink = 0.0;
+
+    results.push_back(run_benchmark(
+        "compute_correlation", number_of_assets,
+        static_cast<size_t>(window_length) * number_of_assets * sizeof(double) + matrix_bytes,
+        min_time_ms,
+        [&]() {
+            compute_correlation_into(
+                window_returns, number_of_assets, window_length, scratch_matrix);
+        }
+    ));
+    print_result(results.back());
+
+    PackedLowerMatrix scratch_packed;
+    results.push_back(run_benchmark(
+        "compute_correlation_packed", number_of_assets,
+        static_cast<size_t>(window_length) * number_of_assets * sizeof(double) + matrix_bytes / 2,
+        min_time_ms,
+        [&]() {
+            compute_correlation_packed_into(
+                window_returns, number_of_assets, window_length, scratch_packed);
+        }
+    ));
+    print_result(results.back());
+
+    results.push_back(run_benchmark(
+        "build_weighted_graph", number_of_assets,
+        2 * matrix_bytes,
+        min_time_ms,
+        [&]() {
+            build_weighted_graph_into(correlation, number_of_assets, scratch_matrix);
+        }
+    ));
+    print_result(results.back());
+
+    results.push_back(run_benchmark(
+        "compute_laplacian", number_of_assets,
+        2 * matrix_bytes,
+        min_time_ms,
+        [&]() {
+            scratch_matrix = weighted_adjacency;
+            compute_laplacian_in_place(scratch_matrix, number_of_assets);
+        }
+    ));
+    print_result(results.back());
+
+    results.push_back(run_benchmark(
+        "compute_graph_total_variation", number_of_assets,
+        matrix_bytes,
+        min_time_ms,
+        [&]() {
+            sink = compute_graph_total_variation(latest_return, laplacian, number_of_assets);
+        }
+    ));
+    print_result(results.back());
+
+    results.push_back(run_benchmark(
+        "diffuse_returns", number_of_assets,
+        matrix_bytes,
+        min_time_ms,
+        [&]() {
+            Vector smoothed = diffuse_returns(laplacian, latest_return, number_of_assets, 1.0);
+            sink = smoothed[0];
+        }
+    ));
+    print_result(results.back());
+
+    results.push_back(run_benchmark(
+        "correlation_to_distance", number_of_assets,
+        2 * matrix_bytes,
+        min_time_ms,
+        [&]() {
+            correlation_to_distance_into(correlation, number_of_assets, scratch_matrix);
+        }
+    ));
+    print_result(results.back());
+
+    if (!skip_topology) {
+        PersistenceDiagram diagram;
+        results.push_back(run_benchmark(
+            "compute_persistence_H1", number_of_assets,
+            matrix_bytes,
+            min_time_ms,
+            [&]() {
+                diagram = compute_persistence_H1(distance_matrix, number_of_assets);
+            }
+        ));
+        print_result(results.back());
+
+        // Previous-day diagram: the same pairs, slightly shifted, which
+        // is representative of consecutive trading days.
+        PersistenceDiagram previous_diagram = diagram;
+        for (PersistencePair& pair : previous_diagram) {
+            pair.birth += 1e-3;
+            pair.death += 2e-3;
+        }
+
+        results.push_back(run_benchmark(
+            "compute_wasserstein_distance", number_of_assets,
+            (diagram.size() + previous_diagram.size()) * 2 * sizeof(double),
+            min_time_ms,
+            [&]() {
+                sink = compute_wasserstein_distance(diagram, previous_diagram);
+            }
+        ));
+        print_result(results.back());
+    }
+
+    (void)sink;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        const std::vector<uint32_t> universe_sizes =
+            parse_sizes(parse_optional_arg(argc, argv, "--sizes", "500,1000,3000"));
+        const int window_length = parse_optional_int_arg(argc, argv, "--window", 50);
+        const double min_time_ms =
+            parse_optional_double_arg(argc, argv, "--min-time-ms", 200.0);
+        const bool skip_topology = has_flag(argc, argv, "--skip-topology");
+        const std::string save_baseline_path =
+            parse_optional_arg(argc, argv, "--save-baseline", "");
+        const std::string compare_baseline_path =
+            parse_optional_arg(argc, argv, "--compare-baseline", "");
+        const double regression_tolerance =
+            parse_optional_double_arg(argc, argv, "--regression-tolerance", 0.10);
+
+        if (window_length < 2) {
+            throw std::runtime_error("--window must be at least 2");
+        }
+
+        std::vector<BenchResult> results;
+
+        for (uint32_t number_of_assets : universe_sizes) {
+            std::cout << std::string(60, '-') << std::endl;
+            std::cout << "Universe: N=" << number_of_assets
+                      << ", window=" << window_length << std::endl;
+            benchmark_universe(
+                number_of_assets,
+                static_cast<uint32_t>(window_length),
+                min_time_ms,
+                skip_topology,
+                results
+            );
+        }
+
+        if (!save_baseline_path.empty()) {
+            save_baseline(results, save_baseline_path);
+            std::cout << std::endl << "Baseline saved to " << save_baseline_path << std::endl;
+        }
+
+        if (!compare_baseline_path.empty()) {
+            const std::map<std::string, double> baseline =
+                load_baseline(compare_baseline_path);
+            const int regressions =
+                compare_against_baseline(results, baseline, regression_tolerance);
+            if (regressions > 0) {
+                std::cerr << "FAILED: " << regressions
+                          << " stage(s) regressed beyond tolerance" << std::endl;
+                return 1;
+            }
+        }
+
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+}
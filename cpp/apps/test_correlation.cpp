@@ -164,7 +164,203 @@ int main(int argc, char* argv[]) {
         std::cout << "  Saved to: " << output_path << std::endl;
         std::cout << std::string(60, '-') << std::endl;
 
-        if (!diagonal_ok || !symmetric || !range_ok || has_nan || has_inf) {
+        // Step 7: Rolling-state equivalence. Rolling the Gram matrix
+        // forward day by day (rank-1 downdate + update) must reproduce
+        // the from-scratch correlation of each shifted window.
+        std::cout << "Step 7: Rolling-window equivalence check..." << std::endl;
+        bool rolling_ok = true;
+        const uint32_t roll_days = (rolling_window_length >= 4)
+            ? std::min(5u, rolling_window_length - 3)
+            : 0;
+        if (roll_days >= 1) {
+            const uint32_t sub_window_length = rolling_window_length - roll_days;
+
+            Matrix initial_window(
+                static_cast<size_t>(sub_window_length) * number_of_assets);
+            std::copy(
+                returns.window_returns.begin(),
+                returns.window_returns.begin() + initial_window.size(),
+                initial_window.begin()
+            );
+
+            RollingCorrelationState rolling_state = init_rolling_correlation(
+                initial_window, number_of_assets, sub_window_length);
+
+            Vector outgoing_returns(number_of_assets);
+            Vector incoming_returns(number_of_assets);
+            Matrix shifted_window(initial_window.size());
+            double max_rolling_diff = 0.0;
+
+            for (uint32_t day = 0; day < roll_days; ++day) {
+                const size_t outgoing_start =
+                    static_cast<size_t>(day) * number_of_assets;
+                const size_t incoming_start =
+                    static_cast<size_t>(sub_window_length + day) * number_of_assets;
+                std::copy(
+                    returns.window_returns.begin() + outgoing_start,
+                    returns.window_returns.begin() + outgoing_start + number_of_assets,
+                    outgoing_returns.begin()
+                );
+                std::copy(
+                    returns.window_returns.begin() + incoming_start,
+                    returns.window_returns.begin() + incoming_start + number_of_assets,
+                    incoming_returns.begin()
+                );
+                roll_correlation_window(rolling_state, outgoing_returns, incoming_returns);
+
+                // From-scratch reference on the same shifted window.
+                const size_t shifted_start =
+                    static_cast<size_t>(day + 1) * number_of_assets;
+                std::copy(
+                    returns.window_returns.begin() + shifted_start,
+                    returns.window_returns.begin() + shifted_start + shifted_window.size(),
+                    shifted_window.begin()
+                );
+                Matrix rolled_correlation =
+                    correlation_from_rolling_state(rolling_state);
+                Matrix reference_correlation = compute_correlation(
+                    shifted_window, number_of_assets, sub_window_length);
+
+                for (size_t k = 0; k < rolled_correlation.size(); ++k) {
+                    max_rolling_diff = std::max(
+                        max_rolling_diff,
+                        std::abs(rolled_correlation[k] - reference_correlation[k])
+                    );
+                }
+            }
+
+            rolling_ok = (max_rolling_diff <= 1e-10);
+            std::cout << "  Rolled " << roll_days << " day(s), max abs diff vs "
+                      << "from-scratch: " << std::scientific << max_rolling_diff
+                      << std::fixed << std::endl;
+            std::cout << "  Rolling state matches recompute (<= 1e-10): "
+                      << (rolling_ok ? "YES (GOOD)" : "NO (BAD)") << std::endl;
+        } else {
+            std::cout << "  Window too short to roll; skipping." << std::endl;
+        }
+        std::cout << std::string(60, '-') << std::endl;
+
+        // Step 8: Masked (pairwise-complete) correlation checks.
+        std::cout << "Step 8: Masked correlation checks..." << std::endl;
+
+        // Punch deterministic holes, and starve asset 0 down to three
+        // observations so the minimum_observations floor is exercised.
+        Matrix holed_returns = returns.window_returns;
+        ValidityMask return_valid(holed_returns.size(), 1);
+        for (size_t k = 0; k < holed_returns.size(); k += 7) {
+            return_valid[k] = 0;
+            holed_returns[k] = 0.0;
+        }
+        for (uint32_t t = 3; t < rolling_window_length; ++t) {
+            const size_t cell = static_cast<size_t>(t) * number_of_assets;
+            return_valid[cell] = 0;
+            holed_returns[cell] = 0.0;
+        }
+
+        const uint32_t minimum_observations = 5;
+        Matrix masked_correlation;
+        std::vector<uint32_t> effective_observations;
+        compute_correlation_masked_into(
+            holed_returns,
+            return_valid,
+            number_of_assets,
+            rolling_window_length,
+            minimum_observations,
+            masked_correlation,
+            effective_observations
+        );
+
+        // Scalar per-pair reference: accumulate over exactly the rows
+        // where both assets are observed.
+        double max_masked_diff = 0.0;
+        bool counts_ok = true;
+        bool floor_ok = true;
+        for (uint32_t i = 0; i < number_of_assets; ++i) {
+            for (uint32_t j = 0; j < number_of_assets; ++j) {
+                uint32_t pair_count = 0;
+                double sum_i = 0.0, sum_j = 0.0;
+                double sum_sq_i = 0.0, sum_sq_j = 0.0;
+                double sum_cross = 0.0;
+                for (uint32_t t = 0; t < rolling_window_length; ++t) {
+                    const size_t cell_i = static_cast<size_t>(t) * number_of_assets + i;
+                    const size_t cell_j = static_cast<size_t>(t) * number_of_assets + j;
+                    if (return_valid[cell_i] == 0 || return_valid[cell_j] == 0) {
+                        continue;
+                    }
+                    const double value_i = holed_returns[cell_i];
+                    const double value_j = holed_returns[cell_j];
+                    pair_count += 1;
+                    sum_i += value_i;
+                    sum_j += value_j;
+                    sum_sq_i += value_i * value_i;
+                    sum_sq_j += value_j * value_j;
+                    sum_cross += value_i * value_j;
+                }
+
+                double expected = 0.0;
+                if (i == j) {
+                    expected = 1.0;
+                } else if (pair_count >= minimum_observations) {
+                    const double covariance = sum_cross - sum_i * sum_j / pair_count;
+                    const double variance_i = sum_sq_i - sum_i * sum_i / pair_count;
+                    const double variance_j = sum_sq_j - sum_j * sum_j / pair_count;
+                    if (variance_i > 1e-20 && variance_j > 1e-20) {
+                        expected = covariance / std::sqrt(variance_i * variance_j);
+                        expected = std::max(-1.0, std::min(1.0, expected));
+                    }
+                }
+
+                const size_t cell = static_cast<size_t>(i) * number_of_assets + j;
+                if (effective_observations[cell] != pair_count) {
+                    counts_ok = false;
+                }
+                if (i != j && pair_count < minimum_observations &&
+                    masked_correlation[cell] != 0.0) {
+                    floor_ok = false;
+                }
+                max_masked_diff = std::max(
+                    max_masked_diff,
+                    std::abs(masked_correlation[cell] - expected)
+                );
+            }
+        }
+        bool masked_match_ok = (max_masked_diff <= 1e-12);
+        std::cout << "  Max abs diff vs scalar per-pair reference: "
+                  << std::scientific << max_masked_diff << std::fixed << std::endl;
+        std::cout << "  Matches scalar reference (<= 1e-12): "
+                  << (masked_match_ok ? "YES (GOOD)" : "NO (BAD)") << std::endl;
+        std::cout << "  Effective counts recorded per pair: "
+                  << (counts_ok ? "YES (GOOD)" : "NO (BAD)") << std::endl;
+        std::cout << "  Below-min-obs pairs forced to 0: "
+                  << (floor_ok ? "YES (GOOD)" : "NO (BAD)") << std::endl;
+
+        // All rows valid must reproduce the dense estimator exactly
+        // (same accumulations, no guard engaged).
+        ValidityMask all_valid(returns.window_returns.size(), 1);
+        Matrix full_mask_correlation;
+        compute_correlation_masked_into(
+            returns.window_returns,
+            all_valid,
+            number_of_assets,
+            rolling_window_length,
+            2,
+            full_mask_correlation,
+            effective_observations
+        );
+        double max_full_mask_diff = 0.0;
+        for (size_t k = 0; k < correlation.size(); ++k) {
+            max_full_mask_diff = std::max(
+                max_full_mask_diff,
+                std::abs(full_mask_correlation[k] - correlation[k])
+            );
+        }
+        bool full_mask_ok = (max_full_mask_diff <= 1e-12);
+        std::cout << "  All-rows-valid matches compute_correlation (<= 1e-12): "
+                  << (full_mask_ok ? "YES (GOOD)" : "NO (BAD)") << std::endl;
+        std::cout << std::string(60, '-') << std::endl;
+
+        if (!diagonal_ok || !symmetric || !range_ok || has_nan || has_inf ||
+            !rolling_ok || !masked_match_ok || !counts_ok || !floor_ok || !full_mask_ok) {
             std::cout << "TEST FAILED: Validation issues detected!" << std::endl;
             return 1;
         }
@@ -10,6 +10,8 @@
  #include <iomanip>
  #include <algorithm>
  #include <cmath>
+ #include <cstdlib>
+ #include <random>
  #include <string>
  
  #include "types.hpp"
@@ -157,7 +159,60 @@
          std::cout << "  If eta>=0, systemic_ratio <= 1 (+eps): "
                    << (ratio_reasonable ? "YES (GOOD)" : "NO (BAD)") << std::endl;
  
-         if (!smoothed_finite || !ratio_finite || !eta_zero_identity_ok || !ratio_reasonable) {
+         // Step 8: Lanczos expmv must match the dense eigendecomposition
+         // backend. MSI_EXPMV_MODE forces each backend on the same random
+         // Laplacian, once below and once above the auto-selection
+         // crossover (512), so the auto run exercises both choices.
+         std::cout << "Step 8: Lanczos vs eigendecomposition equivalence..." << std::endl;
+
+         bool expmv_backends_agree = true;
+         std::mt19937 rng(7);
+         std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+         for (const uint32_t dimension : {64u, 600u}) {
+             Matrix random_adjacency(static_cast<size_t>(dimension) * dimension, 0.0);
+             for (uint32_t i = 0; i < dimension; ++i) {
+                 for (uint32_t j = i + 1; j < dimension; ++j) {
+                     const double weight = uniform(rng);
+                     random_adjacency[static_cast<size_t>(i) * dimension + j] = weight;
+                     random_adjacency[static_cast<size_t>(j) * dimension + i] = weight;
+                 }
+             }
+             Matrix random_laplacian = compute_laplacian(random_adjacency, dimension);
+
+             Vector random_return(dimension);
+             for (double& value : random_return) {
+                 value = 0.02 * (uniform(rng) - 0.5);
+             }
+
+             setenv("MSI_EXPMV_MODE", "eigen", 1);
+             Vector smoothed_eigen = diffuse_returns(
+                 random_laplacian, random_return, dimension, diffusion_eta);
+             setenv("MSI_EXPMV_MODE", "lanczos", 1);
+             Vector smoothed_lanczos = diffuse_returns(
+                 random_laplacian, random_return, dimension, diffusion_eta);
+             unsetenv("MSI_EXPMV_MODE");
+             Vector smoothed_auto = diffuse_returns(
+                 random_laplacian, random_return, dimension, diffusion_eta);
+
+             const double lanczos_vs_eigen =
+                 max_abs_difference(smoothed_lanczos, smoothed_eigen);
+             const double auto_vs_eigen =
+                 max_abs_difference(smoothed_auto, smoothed_eigen);
+             const bool dimension_ok =
+                 (lanczos_vs_eigen <= 1e-9) && (auto_vs_eigen <= 1e-9);
+             expmv_backends_agree = expmv_backends_agree && dimension_ok;
+
+             std::cout << "  N=" << dimension
+                       << ": |lanczos - eigen| = " << std::scientific << lanczos_vs_eigen
+                       << ", |auto - eigen| = " << auto_vs_eigen << std::fixed
+                       << " " << (dimension_ok ? "(GOOD)" : "(BAD)") << std::endl;
+         }
+         std::cout << "  Backends agree (<= 1e-9): "
+                   << (expmv_backends_agree ? "YES (GOOD)" : "NO (BAD)") << std::endl;
+
+         if (!smoothed_finite || !ratio_finite || !eta_zero_identity_ok ||
+             !ratio_reasonable || !expmv_backends_agree) {
              std::cout << "TEST FAILED: Validation issues detected!" << std::endl;
              return 1;
          }
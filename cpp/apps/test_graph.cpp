@@ -6,6 +6,7 @@
  *   ./test_graph <parquet_file_path>
  */
 
+ #include <algorithm>
  #include <iostream>
  #include <cmath>
  
@@ -68,7 +69,48 @@
              std::cerr << "GTV is NaN or Inf!" << std::endl;
              return 1;
          }
- 
+
+         // Packed pipeline: the packed correlation -> packed adjacency
+         // -> Laplacian / GTV route must reproduce the dense results.
+         PackedLowerMatrix correlation_packed;
+         compute_correlation_packed_into(
+             returns.window_returns,
+             number_of_assets,
+            rolling_window_length,
+             correlation_packed
+         );
+
+         PackedLowerMatrix weighted_graph_packed;
+         build_weighted_graph_packed_into(
+             correlation_packed, number_of_assets, weighted_graph_packed);
+
+         Matrix laplacian_from_packed;
+         compute_laplacian_from_packed_into(
+             weighted_graph_packed, number_of_assets, laplacian_from_packed);
+
+         double max_laplacian_diff = 0.0;
+         for (size_t k = 0; k < laplacian.size(); ++k) {
+             max_laplacian_diff = std::max(
+                 max_laplacian_diff,
+                 std::abs(laplacian_from_packed[k] - laplacian[k])
+             );
+         }
+         if (max_laplacian_diff > 1e-12) {
+             std::cerr << "Packed Laplacian differs from dense: "
+                       << max_laplacian_diff << std::endl;
+             return 1;
+         }
+
+         const double gtv_packed = compute_graph_total_variation_packed(
+             returns.latest_return, weighted_graph_packed, number_of_assets);
+         const double gtv_diff = std::abs(gtv_packed - gtv);
+         if (std::isnan(gtv_packed) || gtv_diff > 1e-12 * std::max(1.0, std::abs(gtv))) {
+             std::cerr << "Packed GTV differs from dense: " << gtv_packed
+                       << " vs " << gtv << std::endl;
+             return 1;
+         }
+         std::cout << "Packed Laplacian/GTV match dense: YES" << std::endl;
+
          std::cout << "GTV value: " << gtv << std::endl;
          std::cout << "TEST PASSED" << std::endl;
          return 0;
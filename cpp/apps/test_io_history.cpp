@@ -0,0 +1,151 @@
+/**
+ * @file test_io_history.cpp
+ * @brief Test the appendable strain-history and diagram-log files.
+ *
+ * Usage:
+ *   ./test_io_history
+ *
+ * Writes test_strain_history.bin / test_diagrams.bin in the working
+ * directory (removed and recreated on each run).
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "types.hpp"
+#include "io_history.hpp"
+
+static StrainComponents make_components(const std::string& date, double strain_index) {
+    StrainComponents components;
+    components.date = date;
+    components.l2_return_magnitude = 0.01;
+    components.graph_total_variation = 0.002;
+    components.systemic_ratio = 0.9;
+    components.total_persistence = 1.5;
+    components.wasserstein_distance = 0.3;
+    components.strain_index = strain_index;
+    components.normalized_strain_index = (strain_index - 15.0) / 3.0;
+    return components;
+}
+
+int main() {
+    const std::string history_path = "test_strain_history.bin";
+    const std::string diagram_log_path = "test_diagrams.bin";
+    std::remove(history_path.c_str());
+    std::remove(diagram_log_path.c_str());
+
+    try {
+        // Missing history file: lookup must report no match, not throw.
+        StrainHistoryRecord looked_up{};
+        if (find_latest_history_record_before(history_path, "2026-08-25", looked_up)) {
+            std::cerr << "Lookup on a missing history file returned a match" << std::endl;
+            return 1;
+        }
+        std::cout << "Missing history file returns no match: YES" << std::endl;
+
+        // Append two days, each with its diagram, then a superseding
+        // re-run of the second day.
+        const PersistenceDiagram diagram_day_one{{0.1, 0.4}, {0.2, 0.9}};
+        const PersistenceDiagram diagram_day_two{{0.15, 0.5}};
+        const PersistenceDiagram diagram_day_two_rerun{};
+
+        uint64_t byte_count_one = 0;
+        const uint64_t offset_one =
+            append_diagram_log(diagram_log_path, diagram_day_one, byte_count_one);
+        uint64_t byte_count_two = 0;
+        const uint64_t offset_two =
+            append_diagram_log(diagram_log_path, diagram_day_two, byte_count_two);
+        uint64_t byte_count_rerun = 0;
+        const uint64_t offset_rerun =
+            append_diagram_log(diagram_log_path, diagram_day_two_rerun, byte_count_rerun);
+
+        append_strain_history(
+            history_path, make_components("2026-08-21", 14.0), offset_one, byte_count_one);
+        append_strain_history(
+            history_path, make_components("2026-08-24", 16.0), offset_two, byte_count_two);
+        append_strain_history(
+            history_path, make_components("2026-08-24", 17.0), offset_rerun, byte_count_rerun);
+
+        // Sequential read-back returns every record in append order.
+        const auto records = read_strain_history(history_path);
+        if (records.size() != 3) {
+            std::cerr << "Expected 3 history records, got " << records.size() << std::endl;
+            return 1;
+        }
+        const bool order_ok =
+            std::strcmp(records[0].date, "2026-08-21") == 0 &&
+            std::strcmp(records[1].date, "2026-08-24") == 0 &&
+            std::strcmp(records[2].date, "2026-08-24") == 0 &&
+            records[0].strain_index == 14.0 &&
+            records[1].strain_index == 16.0 &&
+            records[2].strain_index == 17.0;
+        if (!order_ok) {
+            std::cerr << "History read-back does not match appended records" << std::endl;
+            return 1;
+        }
+        std::cout << "History append/read-back round trip: YES" << std::endl;
+
+        // The lookup scans backwards, so the re-run of 2026-08-24
+        // (strain 17) supersedes the original (strain 16).
+        if (!find_latest_history_record_before(history_path, "2026-08-25", looked_up) ||
+            std::strcmp(looked_up.date, "2026-08-24") != 0 ||
+            looked_up.strain_index != 17.0) {
+            std::cerr << "Lookup did not return the superseding re-run record" << std::endl;
+            return 1;
+        }
+        // The upper bound is exclusive: looking up 2026-08-24 itself
+        // must skip both of its records and land on 2026-08-21.
+        if (!find_latest_history_record_before(history_path, "2026-08-24", looked_up) ||
+            std::strcmp(looked_up.date, "2026-08-21") != 0) {
+            std::cerr << "Lookup upper bound is not exclusive" << std::endl;
+            return 1;
+        }
+        // No record strictly before the first date.
+        if (find_latest_history_record_before(history_path, "2026-08-21", looked_up)) {
+            std::cerr << "Lookup before the first record returned a match" << std::endl;
+            return 1;
+        }
+        std::cout << "Superseding re-run lookup semantics: YES" << std::endl;
+
+        // Diagram log round trip via the recorded offsets, including
+        // the empty re-run diagram.
+        const PersistenceDiagram loaded_one =
+            read_diagram_log_at(diagram_log_path, offset_one, byte_count_one);
+        const PersistenceDiagram loaded_rerun =
+            read_diagram_log_at(diagram_log_path, offset_rerun, byte_count_rerun);
+        bool diagrams_ok =
+            loaded_one.size() == diagram_day_one.size() && loaded_rerun.empty();
+        for (size_t i = 0; diagrams_ok && i < loaded_one.size(); ++i) {
+            diagrams_ok = loaded_one[i].birth == diagram_day_one[i].birth &&
+                          loaded_one[i].death == diagram_day_one[i].death;
+        }
+        if (!diagrams_ok) {
+            std::cerr << "Diagram log round trip mismatch" << std::endl;
+            return 1;
+        }
+        std::cout << "Diagram log append/read round trip: YES" << std::endl;
+
+        // A length that disagrees with the stored pair count must be
+        // rejected, not silently mis-read.
+        bool length_mismatch_rejected = false;
+        try {
+            read_diagram_log_at(diagram_log_path, offset_one, byte_count_one - 8);
+        } catch (const std::exception&) {
+            length_mismatch_rejected = true;
+        }
+        if (!length_mismatch_rejected) {
+            std::cerr << "Length mismatch was not rejected" << std::endl;
+            return 1;
+        }
+        std::cout << "Diagram length mismatch rejected: YES" << std::endl;
+
+        std::cout << "TEST PASSED" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -173,7 +173,91 @@ int main(int argc, char* argv[]) {
                   << (reasonable_range ? "YES (GOOD)" : "NO (CHECK DATA)") << std::endl;
         std::cout << std::string(60, '-') << std::endl;
 
-        if (has_nan || has_inf) {
+        // Step 7: Masked returns. Punch deterministic holes in the
+        // price matrix and check the endpoint rule: a return is valid
+        // only when both endpoint prices are observed, masked returns
+        // carry 0.0, and an all-ones mask reproduces compute_log_returns.
+        std::cout << "Step 7: Masked returns checks..." << std::endl;
+
+        Matrix holed_prices = closing_prices;
+        ValidityMask price_valid(holed_prices.size(), 1);
+        for (size_t k = 0; k < holed_prices.size(); k += 7) {
+            price_valid[k] = 0;
+            holed_prices[k] = 0.0;
+        }
+
+        Returns masked_returns;
+        ValidityMask return_valid;
+        compute_log_returns_masked_into(
+            holed_prices,
+            price_valid,
+            number_of_columns,
+            rolling_window_length,
+            masked_returns,
+            return_valid
+        );
+
+        bool masked_rule_ok = true;
+        for (uint32_t t = 0; t < rolling_window_length && masked_rule_ok; ++t) {
+            for (uint32_t j = 0; j < number_of_columns; ++j) {
+                const size_t previous_index =
+                    static_cast<size_t>(t) * number_of_columns + j;
+                const size_t current_index =
+                    static_cast<size_t>(t + 1) * number_of_columns + j;
+                const size_t return_index = previous_index;
+
+                const bool both_observed =
+                    price_valid[previous_index] != 0 &&
+                    price_valid[current_index] != 0 &&
+                    holed_prices[previous_index] > 0.0 &&
+                    holed_prices[current_index] > 0.0;
+
+                if (both_observed) {
+                    const double expected = std::log(
+                        holed_prices[current_index] / holed_prices[previous_index]);
+                    if (return_valid[return_index] != 1 ||
+                        std::abs(masked_returns.window_returns[return_index] - expected) > 1e-14) {
+                        masked_rule_ok = false;
+                        break;
+                    }
+                } else {
+                    if (return_valid[return_index] != 0 ||
+                        masked_returns.window_returns[return_index] != 0.0) {
+                        masked_rule_ok = false;
+                        break;
+                    }
+                }
+            }
+        }
+        std::cout << "  Endpoint rule (both prices observed): "
+                  << (masked_rule_ok ? "YES (GOOD)" : "NO (BAD)") << std::endl;
+
+        ValidityMask all_valid(closing_prices.size(), 1);
+        Returns full_mask_returns;
+        ValidityMask full_mask_valid;
+        compute_log_returns_masked_into(
+            closing_prices,
+            all_valid,
+            number_of_columns,
+            rolling_window_length,
+            full_mask_returns,
+            full_mask_valid
+        );
+
+        bool full_mask_ok = (full_mask_valid ==
+                             ValidityMask(full_mask_valid.size(), 1));
+        for (size_t k = 0; k < returns.window_returns.size(); ++k) {
+            if (std::abs(full_mask_returns.window_returns[k] -
+                         returns.window_returns[k]) > 1e-15) {
+                full_mask_ok = false;
+                break;
+            }
+        }
+        std::cout << "  All-ones mask matches compute_log_returns: "
+                  << (full_mask_ok ? "YES (GOOD)" : "NO (BAD)") << std::endl;
+        std::cout << std::string(60, '-') << std::endl;
+
+        if (has_nan || has_inf || !masked_rule_ok || !full_mask_ok) {
             std::cout << "TEST FAILED: Invalid values detected!" << std::endl;
             return 1;
         }
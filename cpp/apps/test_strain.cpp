@@ -0,0 +1,114 @@
+/**
+ * @file test_strain.cpp
+ * @brief Test the online normalization state (Welford moments).
+ *
+ * Usage:
+ *   ./test_strain
+ *
+ * Writes test_normalization_state.bin in the working directory
+ * (removed and recreated on each run).
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "types.hpp"
+#include "strain.hpp"
+
+int main() {
+    const std::string state_path = "test_normalization_state.bin";
+    std::remove(state_path.c_str());
+
+    try {
+        // Fold in four days and compare against directly computed
+        // population moments.
+        const double samples[] = {12.0, 15.5, 14.0, 18.5};
+        const std::string dates[] = {
+            "2026-08-19", "2026-08-20", "2026-08-21", "2026-08-24"};
+
+        NormalizationState state;
+        for (int i = 0; i < 4; ++i) {
+            update_normalization_state(state, samples[i], dates[i]);
+        }
+
+        double direct_mean = 0.0;
+        for (double sample : samples) {
+            direct_mean += sample;
+        }
+        direct_mean /= 4.0;
+        double direct_m2 = 0.0;
+        for (double sample : samples) {
+            direct_m2 += (sample - direct_mean) * (sample - direct_mean);
+        }
+        const double direct_std_pop = std::sqrt(direct_m2 / 4.0);
+
+        if (state.count != 4 ||
+            std::abs(state.mean - direct_mean) > 1e-12 ||
+            std::abs(normalization_state_std_pop(state) - direct_std_pop) > 1e-12) {
+            std::cerr << "Welford moments disagree with direct computation" << std::endl;
+            return 1;
+        }
+        std::cout << "Welford moments match direct computation: YES" << std::endl;
+
+        // Re-running the last day (or replaying an older one) must not
+        // double-count the sample.
+        NormalizationState replayed = state;
+        update_normalization_state(replayed, 99.0, "2026-08-24");
+        update_normalization_state(replayed, 99.0, "2026-08-19");
+        if (replayed.count != state.count ||
+            replayed.mean != state.mean ||
+            replayed.m2 != state.m2 ||
+            replayed.last_date != state.last_date) {
+            std::cerr << "Same-date re-run changed the state" << std::endl;
+            return 1;
+        }
+        std::cout << "Same-date re-run is idempotent: YES" << std::endl;
+
+        // Save/load round trip, including the NUL-padded date field.
+        save_normalization_state_bin(state, state_path);
+        const NormalizationState loaded = load_normalization_state_bin(state_path);
+        if (loaded.count != state.count ||
+            loaded.mean != state.mean ||
+            loaded.m2 != state.m2 ||
+            loaded.last_date != state.last_date) {
+            std::cerr << "Save/load round trip mismatch" << std::endl;
+            return 1;
+        }
+        std::cout << "Save/load round trip: YES" << std::endl;
+
+        // A missing file is an empty state, not an error.
+        const NormalizationState fresh =
+            load_normalization_state_bin("test_normalization_missing.bin");
+        if (fresh.count != 0 || !fresh.last_date.empty()) {
+            std::cerr << "Missing state file did not yield an empty state" << std::endl;
+            return 1;
+        }
+        std::cout << "Missing file yields empty state: YES" << std::endl;
+
+        // A corrupt header must be rejected, not read as moments.
+        {
+            std::ofstream corrupt(state_path, std::ios::binary | std::ios::trunc);
+            corrupt.write("not a state file", 16);
+        }
+        bool corrupt_rejected = false;
+        try {
+            load_normalization_state_bin(state_path);
+        } catch (const std::exception&) {
+            corrupt_rejected = true;
+        }
+        if (!corrupt_rejected) {
+            std::cerr << "Corrupt header was not rejected" << std::endl;
+            return 1;
+        }
+        std::cout << "Corrupt header rejected: YES" << std::endl;
+
+        std::cout << "TEST PASSED" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+}
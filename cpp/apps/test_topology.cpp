@@ -12,8 +12,10 @@
  *   - compute_wasserstein_distance() (hera)
  */
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <utility>
 #include <cmath>
 
 #include "types.hpp"
@@ -26,6 +28,25 @@ static bool is_finite(double value) {
     return !(std::isnan(value) || std::isinf(value));
 }
 
+/// Compare two diagrams as multisets of (birth, death) pairs.
+static bool diagrams_match(PersistenceDiagram a, PersistenceDiagram b, double tolerance) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    const auto by_birth_then_death = [](const PersistencePair& x, const PersistencePair& y) {
+        return (x.birth != y.birth) ? (x.birth < y.birth) : (x.death < y.death);
+    };
+    std::sort(a.begin(), a.end(), by_birth_then_death);
+    std::sort(b.begin(), b.end(), by_birth_then_death);
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::abs(a[i].birth - b[i].birth) > tolerance ||
+            std::abs(a[i].death - b[i].death) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
         std::cerr << "Usage: " << argv[0] << " <parquet_file_path> [previous_diagram_bin_path]" << std::endl;
@@ -74,6 +95,105 @@ int main(int argc, char* argv[]) {
         save_diagram_bin(diagram, current_diagram_path);
         std::cout << "Wrote diagram: " << current_diagram_path << std::endl;
 
+        // Warm-start checks: every branch of
+        // compute_persistence_H1_warm_start must reproduce the default
+        // diagram exactly.
+        const double pair_tolerance = 1e-12;
+
+        // Cap holds: the diagram itself as "previous" with 25% headroom
+        // puts the cap above every death, so the capped reduction must
+        // match the full run with no fallback needed.
+        PersistenceDiagram warm_cap_holds = compute_persistence_H1_warm_start(
+            distance_matrix, number_of_assets, diagram, 0.25);
+        const bool cap_holds_ok = diagrams_match(warm_cap_holds, diagram, pair_tolerance);
+        std::cout << "Warm start, cap holds: "
+                  << (cap_holds_ok ? "MATCH" : "MISMATCH") << std::endl;
+
+        // Cap clips: fabricate a previous diagram whose implied cap
+        // falls strictly between the birth and death of the longest-
+        // lived class. That class is still alive at the cap, so the
+        // open-interval count must trigger the full-run fallback and
+        // the result must still be the exact diagram.
+        bool cap_clips_ok = true;
+        if (!diagram.empty()) {
+            PersistencePair longest_lived = diagram[0];
+            for (const PersistencePair& pair : diagram) {
+                if (pair.death > longest_lived.death) {
+                    longest_lived = pair;
+                }
+            }
+            const double clipping_cap =
+                0.5 * (longest_lived.birth + longest_lived.death);
+            PersistenceDiagram clipping_previous{{0.0, clipping_cap}};
+            PersistenceDiagram warm_cap_clips = compute_persistence_H1_warm_start(
+                distance_matrix, number_of_assets, clipping_previous, 0.0);
+            cap_clips_ok = diagrams_match(warm_cap_clips, diagram, pair_tolerance);
+        }
+        std::cout << "Warm start, cap clips (fallback): "
+                  << (cap_clips_ok ? "MATCH" : "MISMATCH") << std::endl;
+
+        // Empty previous diagram: no cap to derive, must degrade to the
+        // default enclosing-radius path.
+        PersistenceDiagram warm_empty_previous = compute_persistence_H1_warm_start(
+            distance_matrix, number_of_assets, PersistenceDiagram{}, 0.25);
+        const bool empty_previous_ok =
+            diagrams_match(warm_empty_previous, diagram, pair_tolerance);
+        std::cout << "Warm start, empty previous: "
+                  << (empty_previous_ok ? "MATCH" : "MISMATCH") << std::endl;
+
+        // Cap at or above the enclosing radius saves nothing, must also
+        // degrade to the default path. d = sqrt(2*(1-M)) <= 2, so a
+        // previous death of 10 puts the cap far beyond any distance.
+        PersistenceDiagram huge_previous{{0.0, 10.0}};
+        PersistenceDiagram warm_huge_cap = compute_persistence_H1_warm_start(
+            distance_matrix, number_of_assets, huge_previous, 0.0);
+        const bool huge_cap_ok =
+            diagrams_match(warm_huge_cap, diagram, pair_tolerance);
+        std::cout << "Warm start, cap >= enclosing radius: "
+                  << (huge_cap_ok ? "MATCH" : "MISMATCH") << std::endl;
+
+        if (!cap_holds_ok || !cap_clips_ok || !empty_previous_ok || !huge_cap_ok) {
+            std::cerr << "Warm-start diagram mismatch" << std::endl;
+            return 1;
+        }
+
+        // Packed pipeline: packed correlation -> packed float distances
+        // (moved into Ripser with no extraction copy) must reproduce the
+        // dense diagram. The packed route narrows to float before the
+        // reduction, so compare against the dense-double diagram at
+        // float precision, and against the dense-float overload exactly.
+        PackedLowerMatrix correlation_packed;
+        compute_correlation_packed_into(
+            returns.window_returns, number_of_assets, rolling_window_length,
+            correlation_packed);
+
+        PackedLowerMatrixF distance_packed;
+        correlation_to_distance_packed_into(
+            correlation_packed, number_of_assets, distance_packed);
+
+        PersistenceDiagram packed_diagram = compute_persistence_H1_packed(
+            std::move(distance_packed), number_of_assets, 0.0);
+
+        MatrixF distance_matrix_f(distance_matrix.size());
+        for (size_t k = 0; k < distance_matrix.size(); ++k) {
+            distance_matrix_f[k] = static_cast<float>(distance_matrix[k]);
+        }
+        PersistenceDiagram dense_float_diagram = compute_persistence_H1(
+            distance_matrix_f, number_of_assets, 0.0);
+
+        const bool packed_vs_dense_ok =
+            diagrams_match(packed_diagram, diagram, 1e-5);
+        const bool packed_vs_float_ok =
+            diagrams_match(packed_diagram, dense_float_diagram, 0.0);
+        std::cout << "Packed diagram vs dense (float tolerance): "
+                  << (packed_vs_dense_ok ? "MATCH" : "MISMATCH") << std::endl;
+        std::cout << "Packed diagram vs dense-float (exact): "
+                  << (packed_vs_float_ok ? "MATCH" : "MISMATCH") << std::endl;
+        if (!packed_vs_dense_ok || !packed_vs_float_ok) {
+            std::cerr << "Packed-pipeline diagram mismatch" << std::endl;
+            return 1;
+        }
+
         // Wasserstein distance (optional)
         if (has_previous) {
             PersistenceDiagram previous_diagram = load_diagram_bin(previous_diagram_path);
@@ -11,6 +11,9 @@
  *             [--target-lower 0.6] [--target-upper 0.8]
  *             [--tol 0.01] [--max-files 60]
  *             [--eta-lower-start 0.002] [--eta-upper-start 0.006] [--eta-upper-max 64.0]
+ *             [--threads N]   (0 = OpenMP runtime default)
+ *             [--numa-node K] (pin threads to NUMA node K's CPUs)
+ *             [--spectral-cache-dir <dir>]  (persist/reuse eigendecompositions)
  *
  * inputs-list format:
  *   One parquet path per line.
@@ -32,11 +35,18 @@
 #include <Eigen/Dense>
 #include <Eigen/Eigenvalues>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "types.hpp"
+#include "io_cache.hpp"
 #include "io_parquet.hpp"
 #include "returns.hpp"
 #include "correlation.hpp"
 #include "graph.hpp"
+#include "diffusion.hpp"
+#include "numa.hpp"
 
 struct SmoothnessCache {
     std::string parquet_path;
@@ -235,14 +245,34 @@ static double compute_average_smoothness(
     throw std::runtime_error("compute_average_smoothness(InputItem, eta) removed: use cached version");
 }
 
-static SmoothnessCache build_smoothness_cache_or_throw(const InputItem& item) {
-    uint32_t number_of_price_rows = 0;
-    uint32_t number_of_assets = 0;
+/**
+ * @brief Sidecar path for a persisted eigendecomposition, keyed by the
+ *        content hash of the source parquet file.
+ */
+static std::string spectral_cache_path_for(
+    const std::string& spectral_cache_dir,
+    uint64_t input_file_hash
+) {
+    std::ostringstream file_name;
+    file_name << std::hex << input_file_hash << ".spectral.bin";
+    return (std::filesystem::path(spectral_cache_dir) / file_name.str()).string();
+}
 
-    Matrix closing_prices = read_close_prices_parquet(
-        item.parquet_path,
-        number_of_price_rows,
-        number_of_assets
+static SmoothnessCache build_smoothness_cache_or_throw(
+    const InputItem& item,
+    const std::string& spectral_cache_dir
+) {
+    // Go through the mmap price cache: the parquet is decoded at most
+    // once per file, repeated sweeps map the binary sidecar directly.
+    PriceCacheView price_view = read_close_prices_cached_or_build(item.parquet_path);
+
+    const uint32_t number_of_price_rows = price_view.number_of_rows;
+    const uint32_t number_of_assets = price_view.number_of_columns;
+
+    Matrix closing_prices(
+        price_view.data,
+        price_view.data +
+            static_cast<size_t>(number_of_price_rows) * static_cast<size_t>(number_of_assets)
     );
 
     if (number_of_price_rows < 2) {
@@ -252,37 +282,57 @@ static SmoothnessCache build_smoothness_cache_or_throw(const InputItem& item) {
     const uint32_t rolling_window_length = number_of_price_rows - 1;
     Returns returns = compute_log_returns(closing_prices, number_of_assets, rolling_window_length);
 
-    Matrix correlation = compute_correlation(returns.window_returns, number_of_assets, rolling_window_length);
-    Matrix weighted_adjacency = build_weighted_graph(correlation, number_of_assets);
-    Matrix laplacian = compute_laplacian(weighted_adjacency, number_of_assets);
-
     const double latest_norm = l2_norm(returns.latest_return);
 
-    Eigen::MatrixXd laplacian_matrix =
-        Eigen::MatrixXd::Zero(static_cast<int>(number_of_assets), static_cast<int>(number_of_assets));
-    for (uint32_t row_index = 0; row_index < number_of_assets; ++row_index) {
-        for (uint32_t column_index = 0; column_index < number_of_assets; ++column_index) {
-            const size_t flat_index =
-                static_cast<size_t>(row_index) * static_cast<size_t>(number_of_assets) +
-                static_cast<size_t>(column_index);
-            laplacian_matrix(static_cast<int>(row_index), static_cast<int>(column_index)) =
-                laplacian[flat_index];
+    // Reuse a persisted eigendecomposition keyed by the input file hash
+    // when available; otherwise run the full chain and persist it for
+    // the next sweep (and for daily_run re-runs over the same day).
+    SpectralDecomposition decomposition;
+    bool loaded_from_sidecar = false;
+    uint64_t input_file_hash = 0;
+    std::string sidecar_path;
+
+    if (!spectral_cache_dir.empty()) {
+        input_file_hash = compute_file_hash_fnv1a(item.parquet_path);
+        sidecar_path = spectral_cache_path_for(spectral_cache_dir, input_file_hash);
+        if (std::filesystem::exists(std::filesystem::path(sidecar_path))) {
+            try {
+                uint32_t cached_assets = 0;
+                uint64_t cached_hash = 0;
+                SpectralDecomposition cached =
+                    load_spectral_cache_bin(sidecar_path, cached_assets, cached_hash);
+                if (cached_assets == number_of_assets && cached_hash == input_file_hash) {
+                    decomposition = std::move(cached);
+                    loaded_from_sidecar = true;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "WARNING: ignoring unreadable spectral cache "
+                          << sidecar_path << " : " << e.what() << "\n";
+            }
         }
     }
 
-    Eigen::VectorXd latest_return_vector = Eigen::VectorXd::Zero(static_cast<int>(number_of_assets));
-    for (uint32_t asset_index = 0; asset_index < number_of_assets; ++asset_index) {
-        latest_return_vector(static_cast<int>(asset_index)) =
-            returns.latest_return[static_cast<size_t>(asset_index)];
-    }
+    if (!loaded_from_sidecar) {
+        Matrix correlation = compute_correlation(returns.window_returns, number_of_assets, rolling_window_length);
+        Matrix weighted_adjacency = build_weighted_graph(correlation, number_of_assets);
+        Matrix laplacian = compute_laplacian(weighted_adjacency, number_of_assets);
 
-    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigen_solver(laplacian_matrix);
-    if (eigen_solver.info() != Eigen::Success) {
-        throw std::runtime_error("SelfAdjointEigenSolver failed for Laplacian matrix");
+        decomposition = compute_spectral_decomposition(laplacian, number_of_assets);
+
+        if (!spectral_cache_dir.empty()) {
+            save_spectral_cache_bin(
+                decomposition,
+                number_of_assets,
+                input_file_hash,
+                sidecar_path
+            );
+        }
     }
 
-    const Eigen::VectorXd eigenvalues = eigen_solver.eigenvalues();
-    const Eigen::MatrixXd eigenvectors = eigen_solver.eigenvectors();
+    Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+        eigenvectors(decomposition.eigenvectors.data(), number_of_assets, number_of_assets);
+    Eigen::Map<const Eigen::VectorXd> latest_return_vector(
+        returns.latest_return.data(), number_of_assets);
 
     const Eigen::VectorXd projected = eigenvectors.transpose() * latest_return_vector;
 
@@ -293,7 +343,7 @@ static SmoothnessCache build_smoothness_cache_or_throw(const InputItem& item) {
     cache.projected_return_squared.resize(static_cast<size_t>(number_of_assets));
 
     for (uint32_t i = 0; i < number_of_assets; ++i) {
-        const double lambda_value = eigenvalues(static_cast<int>(i));
+        const double lambda_value = decomposition.eigenvalues[static_cast<size_t>(i)];
         const double projected_value = projected(static_cast<int>(i));
         if (!is_finite(lambda_value) || !is_finite(projected_value)) {
             throw std::runtime_error("Non-finite eigen decomposition results");
@@ -306,18 +356,22 @@ static SmoothnessCache build_smoothness_cache_or_throw(const InputItem& item) {
 }
 
 static std::vector<SmoothnessCache> build_all_smoothness_caches(
-    const std::vector<InputItem>& inputs
+    const std::vector<InputItem>& inputs,
+    const std::string& spectral_cache_dir
 ) {
     std::vector<std::optional<SmoothnessCache>> cache_slots(inputs.size());
     std::vector<std::string> error_messages(inputs.size());
 
+    // Each iteration is an independent returns -> correlation ->
+    // Laplacian -> eigendecomposition chain; dynamic scheduling keeps
+    // cores busy when input files differ in size.
 #ifdef _OPENMP
-#include <omp.h>
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic)
 #endif
     for (int i = 0; i < static_cast<int>(inputs.size()); ++i) {
         try {
-            cache_slots[static_cast<size_t>(i)] = build_smoothness_cache_or_throw(inputs[static_cast<size_t>(i)]);
+            cache_slots[static_cast<size_t>(i)] =
+                build_smoothness_cache_or_throw(inputs[static_cast<size_t>(i)], spectral_cache_dir);
         } catch (const std::exception& e) {
             error_messages[static_cast<size_t>(i)] = e.what();
         }
@@ -351,56 +405,95 @@ static std::vector<SmoothnessCache> build_all_smoothness_caches(
     return caches;
 }
 
-static double compute_average_smoothness_cached(
+/**
+ * @brief Average smoothness for a whole grid of etas in one cache pass.
+ *
+ * The bracketing/refinement search evaluates dozens of candidate etas;
+ * evaluating them one at a time re-reads every cache per candidate.
+ * This walks the caches once (parallel over files) and, per cache,
+ * evaluates the spectral filter for all etas with the exp over the
+ * eigenvalue array vectorized:
+ *
+ *   Smoothness_eta = sqrt(sum_k exp(-2 eta lambda_k) p_k^2) / ||r||
+ *
+ * @return Average smoothness per eta, in input order.
+ */
+static std::vector<double> compute_average_smoothness_grid(
     const std::vector<SmoothnessCache>& caches,
-    double diffusion_eta
+    const std::vector<double>& diffusion_etas
 ) {
-    if (!is_finite(diffusion_eta) || diffusion_eta < 0.0) {
-        throw std::runtime_error("diffusion_eta must be finite and >= 0");
+    if (diffusion_etas.empty()) {
+        throw std::runtime_error("diffusion_etas must not be empty");
+    }
+    for (double diffusion_eta : diffusion_etas) {
+        if (!is_finite(diffusion_eta) || diffusion_eta < 0.0) {
+            throw std::runtime_error("diffusion_eta must be finite and >= 0");
+        }
     }
 
-    std::vector<double> smoothness_values(caches.size(), 0.0);
+    const size_t eta_count = diffusion_etas.size();
+
+    // smoothness_matrix[i * eta_count + k]: smoothness of cache i at
+    // eta k. Rows are independent, so the file loop parallelizes.
+    std::vector<double> smoothness_matrix(caches.size() * eta_count, 0.0);
     std::vector<int> ok_flags(caches.size(), 1);
 
 #ifdef _OPENMP
-#include <omp.h>
-#pragma omp parallel for
+#pragma omp parallel for schedule(static)
 #endif
     for (int i = 0; i < static_cast<int>(caches.size()); ++i) {
         const SmoothnessCache& cache = caches[static_cast<size_t>(i)];
+        double* smoothness_row =
+            smoothness_matrix.data() + static_cast<size_t>(i) * eta_count;
+
         if (cache.latest_return_norm == 0.0) {
-            smoothness_values[static_cast<size_t>(i)] = 0.0;
-            ok_flags[static_cast<size_t>(i)] = 1;
             continue;
         }
 
-        double smoothed_sum_squares = 0.0;
-        for (size_t k = 0; k < cache.eigenvalues.size(); ++k) {
-            const double lambda_value = cache.eigenvalues[k];
-            const double coefficient = std::exp(-2.0 * diffusion_eta * lambda_value);
-            smoothed_sum_squares += coefficient * cache.projected_return_squared[k];
-        }
-
-        const double smoothed_norm = std::sqrt(std::max(0.0, smoothed_sum_squares));
-        const double smoothness = smoothed_norm / cache.latest_return_norm;
-        if (!is_finite(smoothness)) {
-            ok_flags[static_cast<size_t>(i)] = 0;
-            smoothness_values[static_cast<size_t>(i)] = std::numeric_limits<double>::quiet_NaN();
-            continue;
+        Eigen::Map<const Eigen::ArrayXd> eigenvalue_array(
+            cache.eigenvalues.data(),
+            static_cast<Eigen::Index>(cache.eigenvalues.size()));
+        Eigen::Map<const Eigen::ArrayXd> projected_squared_array(
+            cache.projected_return_squared.data(),
+            static_cast<Eigen::Index>(cache.projected_return_squared.size()));
+
+        for (size_t k = 0; k < eta_count; ++k) {
+            const double smoothed_sum_squares =
+                ((-2.0 * diffusion_etas[k] * eigenvalue_array).exp() *
+                 projected_squared_array).sum();
+
+            const double smoothed_norm = std::sqrt(std::max(0.0, smoothed_sum_squares));
+            const double smoothness = smoothed_norm / cache.latest_return_norm;
+            if (!is_finite(smoothness)) {
+                ok_flags[static_cast<size_t>(i)] = 0;
+                break;
+            }
+            smoothness_row[k] = smoothness;
         }
-        smoothness_values[static_cast<size_t>(i)] = smoothness;
-        ok_flags[static_cast<size_t>(i)] = 1;
     }
 
-    double sum_smoothness = 0.0;
-    for (size_t i = 0; i < smoothness_values.size(); ++i) {
+    std::vector<double> average_smoothness(eta_count, 0.0);
+    for (size_t i = 0; i < caches.size(); ++i) {
         if (ok_flags[i] == 0) {
             throw std::runtime_error("Smoothness computed as NaN/Inf for cached input");
         }
-        sum_smoothness += smoothness_values[i];
+        for (size_t k = 0; k < eta_count; ++k) {
+            average_smoothness[k] += smoothness_matrix[i * eta_count + k];
+        }
+    }
+    for (size_t k = 0; k < eta_count; ++k) {
+        average_smoothness[k] /= static_cast<double>(caches.size());
     }
 
-    return sum_smoothness / static_cast<double>(smoothness_values.size());
+    return average_smoothness;
+}
+
+static double compute_average_smoothness_cached(
+    const std::vector<SmoothnessCache>& caches,
+    double diffusion_eta
+) {
+    return compute_average_smoothness_grid(
+        caches, std::vector<double>{diffusion_eta})[0];
 }
 
 /**
@@ -410,7 +503,13 @@ static double compute_average_smoothness_cached(
  *
  * Strategy:
  * - If smoothness(eta=0) is already within range -> return 0.
- * - Otherwise, find the smallest eta such that smoothness(eta) <= target_upper.
+ * - Otherwise, find the smallest eta such that smoothness(eta) <= target_upper
+ *   by coarse-grid-then-refine: each round lays a grid across the
+ *   current bracket and evaluates the whole grid in ONE pass over the
+ *   caches (compute_average_smoothness_grid), then narrows the bracket
+ *   to the first grid cell that crosses target_upper. The first round
+ *   is log-spaced over [eta_lower_start, eta_upper_max] (replacing the
+ *   old sequential doubling), later rounds are linear in the bracket.
  * - Verify the achieved smoothness is still >= target_lower.
  */
 static double calibrate_eta_for_smoothness_range(
@@ -454,40 +553,75 @@ static double calibrate_eta_for_smoothness_range(
         return 0.0;
     }
 
-    double lower_eta = eta_lower_start;
-    double upper_eta = eta_upper_start;
-
-    if (upper_eta <= lower_eta) {
+    if (eta_upper_start <= eta_lower_start) {
         throw std::runtime_error("eta_upper_start must be > eta_lower_start");
     }
 
-    // If lower_eta already satisfies the upper bound, search below it for the smallest eta.
-    const double smoothness_at_lower = compute_average_smoothness_cached(caches, lower_eta);
-    if (smoothness_at_lower <= target_upper) {
-        upper_eta = lower_eta;
-        lower_eta = 0.0;
-    }
+    // Each refinement round shrinks the bracket by (points - 1); sizing
+    // the rounds from max_iterations keeps the final bracket at least
+    // as tight as max_iterations bisection steps would have been.
+    const int grid_points_per_round = 17;
+    const double shrink_per_round = std::log2(static_cast<double>(grid_points_per_round - 1));
+    const int refinement_rounds = std::max(
+        1,
+        static_cast<int>(std::ceil(static_cast<double>(max_iterations) / shrink_per_round))
+    );
 
-    while (upper_eta < eta_upper_max) {
-        const double smoothness_at_upper = compute_average_smoothness_cached(caches, upper_eta);
-        if (smoothness_at_upper <= target_upper) {
-            break;
+    double lower_eta = 0.0;
+    double upper_eta = eta_upper_max;
+    std::vector<double> grid_etas(static_cast<size_t>(grid_points_per_round));
+
+    for (int round = 0; round < refinement_rounds; ++round) {
+        if (round == 0) {
+            // Coarse round: log-spaced across the full admissible range
+            // (etas of interest span decades).
+            const double log_lower = std::log(eta_lower_start);
+            const double log_upper = std::log(eta_upper_max);
+            for (int k = 0; k < grid_points_per_round; ++k) {
+                const double position =
+                    static_cast<double>(k) / (grid_points_per_round - 1);
+                grid_etas[static_cast<size_t>(k)] =
+                    std::exp(log_lower + position * (log_upper - log_lower));
+            }
+        } else {
+            for (int k = 0; k < grid_points_per_round; ++k) {
+                const double position =
+                    static_cast<double>(k) / (grid_points_per_round - 1);
+                grid_etas[static_cast<size_t>(k)] =
+                    lower_eta + position * (upper_eta - lower_eta);
+            }
         }
-        upper_eta *= 2.0;
-    }
-    if (upper_eta > eta_upper_max) {
-        upper_eta = eta_upper_max;
-    }
 
-    for (int iteration = 0; iteration < max_iterations; ++iteration) {
-        const double mid_eta = 0.5 * (lower_eta + upper_eta);
-        const double mid_smoothness = compute_average_smoothness_cached(caches, mid_eta);
+        const std::vector<double> grid_smoothness =
+            compute_average_smoothness_grid(caches, grid_etas);
+
+        // Smallest grid point already at or below target_upper bounds
+        // the answer from above; its predecessor bounds it from below.
+        int crossing_index = -1;
+        for (int k = 0; k < grid_points_per_round; ++k) {
+            if (grid_smoothness[static_cast<size_t>(k)] <= target_upper) {
+                crossing_index = k;
+                break;
+            }
+        }
 
-        // We want the smallest eta such that smoothness <= target_upper.
-        if (mid_smoothness > target_upper) {
-            lower_eta = mid_eta;
-        } else {
-            upper_eta = mid_eta;
+        if (crossing_index < 0) {
+            // Even eta_upper_max does not reach the target; mirror the
+            // old bracketing behavior and let the final check decide.
+            lower_eta = upper_eta = eta_upper_max;
+            break;
+        }
+        if (crossing_index == 0 && round == 0) {
+            // The target is crossed at or below eta_lower_start; refine
+            // down to zero.
+            lower_eta = 0.0;
+            upper_eta = grid_etas[0];
+            continue;
+        }
+
+        upper_eta = grid_etas[static_cast<size_t>(crossing_index)];
+        if (crossing_index > 0) {
+            lower_eta = grid_etas[static_cast<size_t>(crossing_index - 1)];
         }
     }
 
@@ -523,11 +657,42 @@ int main(int argc, char* argv[]) {
     const double eta_upper_start = optional_double_value(argc, argv, "--eta-upper-start", 0.007);
     const double eta_upper_max = optional_double_value(argc, argv, "--eta-upper-max", 64.0);
     const int max_iterations = optional_int_value(argc, argv, "--max-iterations", 20);
+    const int thread_count = optional_int_value(argc, argv, "--threads", 0);
+    const std::string spectral_cache_dir =
+        optional_arg_value(argc, argv, "--spectral-cache-dir", "");
+
+    if (!spectral_cache_dir.empty()) {
+        std::filesystem::create_directories(std::filesystem::path(spectral_cache_dir));
+    }
+
+    if (thread_count < 0) {
+        throw std::runtime_error("--threads must be >= 0 (0 = runtime default)");
+    }
+
+    // NUMA pinning (default: off). Must run before the first parallel
+    // region so OpenMP workers inherit the affinity mask.
+    const int numa_node = optional_int_value(argc, argv, "--numa-node", -1);
+    if (numa_node >= 0) {
+        const uint32_t pinned_cpu_count =
+            pin_threads_to_numa_node(static_cast<uint32_t>(numa_node));
+        std::cout << "NUMA pinned to node " << numa_node
+                  << " (" << pinned_cpu_count << " CPUs)" << std::endl;
+    }
+#ifdef _OPENMP
+    if (thread_count > 0) {
+        omp_set_num_threads(thread_count);
+    }
+#else
+    if (thread_count > 1) {
+        std::cerr << "WARNING: built without OpenMP; --threads ignored\n";
+    }
+#endif
 
     const std::vector<InputItem> all_inputs = read_inputs_list(inputs_list_path);
     const std::vector<InputItem> selected_inputs = select_evenly_spaced(all_inputs, max_files);
 
-    const std::vector<SmoothnessCache> caches = build_all_smoothness_caches(selected_inputs);
+    const std::vector<SmoothnessCache> caches =
+        build_all_smoothness_caches(selected_inputs, spectral_cache_dir);
 
     double final_target_lower = target_lower;
     double final_target_upper = target_upper;
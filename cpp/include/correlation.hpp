@@ -25,6 +25,164 @@ Matrix compute_correlation(
     uint32_t window_length
 );
 
+/**
+ * @brief Compute correlation matrix into a caller-provided buffer.
+ *
+ * Identical to compute_correlation, but writes into out_correlation
+ * (resized if needed) so repeated runs reuse one allocation.
+ *
+ * @param returns Return matrix [m x N].
+ * @param number_of_assets Number of assets (N).
+ * @param window_length Window length (m).
+ * @param out_correlation Output buffer, resized to [N x N].
+ */
+void compute_correlation_into(
+    const Matrix& returns,
+    uint32_t number_of_assets,
+    uint32_t window_length,
+    Matrix& out_correlation
+);
+
+/**
+ * @brief Compute the correlation matrix in packed lower-triangle form.
+ *
+ * Same estimator as compute_correlation, but the SYRK covariance is
+ * never mirrored into the upper triangle and the normalization writes
+ * straight into packed storage (the unit diagonal is implicit), so the
+ * stored output is N*(N-1)/2 entries instead of N*N. For consumers that
+ * do not need the dense artifact (packed graph/topology stages,
+ * research jobs at large N).
+ *
+ * @param returns Return matrix [m x N].
+ * @param number_of_assets Number of assets (N).
+ * @param window_length Window length (m).
+ * @param out_correlation_packed Output packed buffer, resized.
+ */
+void compute_correlation_packed_into(
+    const Matrix& returns,
+    uint32_t number_of_assets,
+    uint32_t window_length,
+    PackedLowerMatrix& out_correlation_packed
+);
+
+/**
+ * @brief Pairwise-complete correlation for returns with missing data.
+ *
+ * Purpose:
+ *   Correlate the raw extended universe (halts, late listings,
+ *   delistings) without dropping whole columns: each pair (i, j) is
+ *   estimated over exactly the rows where both assets are observed.
+ *
+ * Formula (per pair, over the n_ij rows valid for both assets):
+ *   n    = (V^T V)_{ij}         with V the 0/1 validity mask
+ *   s_i  = (X^T V)_{ij}, s_j = (X^T V)_{ji}   masked row sums
+ *   q_i  = ((X.*X)^T V)_{ij}, q_j likewise    masked squared sums
+ *   p    = (X^T X)_{ij}                       masked cross products
+ *   cov  = (p - s_i s_j / n),  var_k = q_k - s_k^2 / n
+ *   M_ij = cov / sqrt(var_i var_j), clamped to [-1, 1]
+ * All four accumulations are plain matrix products (X carries 0.0 at
+ * masked cells), so the mask-aware pass is four GEMMs, not a scalar
+ * loop. Pairs with fewer than minimum_observations rows or a
+ * degenerate variance get M_ij = 0; the diagonal is exactly 1.
+ *
+ * @param returns Return matrix [m x N], 0.0 at masked cells.
+ * @param return_valid Validity mask for returns, same layout.
+ * @param number_of_assets Number of assets (N).
+ * @param window_length Window length (m).
+ * @param minimum_observations Minimum pairwise-complete rows for an
+ *        estimate (at least 2).
+ * @param out_correlation Output correlation matrix [N x N], resized.
+ * @param out_effective_observations Effective pairwise observation
+ *        counts n_ij [N x N], resized.
+ */
+void compute_correlation_masked_into(
+    const Matrix& returns,
+    const ValidityMask& return_valid,
+    uint32_t number_of_assets,
+    uint32_t window_length,
+    uint32_t minimum_observations,
+    Matrix& out_correlation,
+    std::vector<uint32_t>& out_effective_observations
+);
+
+/**
+ * @brief Incremental state for rolling-window correlation.
+ *
+ * Purpose:
+ *   Allow consecutive daily windows (which share m-1 of their m rows)
+ *   to reuse the accumulated Gram matrix instead of recomputing the
+ *   full [N x m] x [m x N] product each day.
+ *
+ * Contents:
+ *   gram:        G = X^T X over the current window, row-major [N x N]
+ *   column_sums: sum_t x_{t,i} for each asset [N]
+ */
+struct RollingCorrelationState {
+    uint32_t number_of_assets;
+    uint32_t window_length;
+    Matrix gram;
+    Vector column_sums;
+};
+
+/**
+ * @brief Initialize rolling correlation state from a full window.
+ *
+ * Computes G = X^T X and per-asset column sums for the initial window.
+ *
+ * @param returns Return matrix [m x N].
+ * @param number_of_assets Number of assets (N).
+ * @param window_length Window length (m).
+ * @return Initialized rolling state.
+ */
+RollingCorrelationState init_rolling_correlation(
+    const Matrix& returns,
+    uint32_t number_of_assets,
+    uint32_t window_length
+);
+
+/**
+ * @brief Slide the rolling window forward by one day.
+ *
+ * Applies a rank-1 downdate for the outgoing (oldest) return row and a
+ * rank-1 update for the incoming (newest) return row:
+ *   G <- G - x_out x_out^T + x_in x_in^T
+ *
+ * @param state Rolling state to update in place.
+ * @param outgoing_returns Return row leaving the window [N].
+ * @param incoming_returns Return row entering the window [N].
+ */
+void roll_correlation_window(
+    RollingCorrelationState& state,
+    const Vector& outgoing_returns,
+    const Vector& incoming_returns
+);
+
+/**
+ * @brief Compute the correlation matrix from rolling state.
+ *
+ * Recovers the covariance from the Gram matrix and column sums:
+ *   Cov = (G - s s^T / m) / (m - 1)
+ * then normalizes exactly as compute_correlation does.
+ *
+ * @param state Current rolling state.
+ * @return Dense correlation matrix M(t), shape [N x N].
+ */
+Matrix correlation_from_rolling_state(const RollingCorrelationState& state);
+
+/**
+ * @brief Compute the rolling-state correlation into a caller buffer.
+ *
+ * Buffer-reusing variant of correlation_from_rolling_state for batch
+ * loops that evaluate the state once per day.
+ *
+ * @param state Current rolling state.
+ * @param out_correlation Output buffer, resized to [N x N].
+ */
+void correlation_from_rolling_state_into(
+    const RollingCorrelationState& state,
+    Matrix& out_correlation
+);
+
 /**
  * @brief Save correlation matrix to a binary file.
  *
@@ -12,7 +12,11 @@
  *   s_t = exp(-eta * L) * r_t
  *
  * Implementation note:
- *   Uses symmetric eigendecomposition or Krylov expmv.
+ *   Uses symmetric eigendecomposition or Krylov expmv. Small problems
+ *   run the full SelfAdjointEigenSolver; above a size threshold a
+ *   Lanczos expmv computes s_t with a few dozen matvecs instead of the
+ *   O(N^3) factorization. Selection is automatic; set MSI_EXPMV_MODE to
+ *   "eigen" or "lanczos" to force a backend.
  *
  * @param laplacian Graph Laplacian L [N x N].
  * @param latest_return Latest return vector r_t [N].
@@ -29,6 +33,147 @@ Vector diffuse_returns(
     double diffusion_eta
 );
 
+/**
+ * @brief Diffuse returns over a sparse market network.
+ *
+ * Purpose:
+ *   Matrix-free counterpart of diffuse_returns for thresholded graphs.
+ *
+ * Formula:
+ *   s_t = exp(-eta * L) * r_t
+ *
+ * Implementation note:
+ *   Uses scaling with a truncated Taylor expansion driven by sparse
+ *   matvecs; no dense matrix or eigendecomposition is formed. The step
+ *   count is chosen from the Gershgorin bound on the Laplacian spectrum
+ *   so each sub-step series converges quickly.
+ *
+ * @param laplacian Sparse graph Laplacian L (CSR).
+ * @param latest_return Latest return vector r_t [N].
+ * @param number_of_assets Number of assets (N).
+ * @param diffusion_eta Diffusion parameter eta.
+ * @return Smoothed return vector s_t [N].
+ */
+Vector diffuse_returns_sparse(
+    const SparseMatrixCSR& laplacian,
+    const Vector& latest_return,
+    uint32_t number_of_assets,
+    double diffusion_eta
+);
+
+/**
+ * @brief Spectral factorization of a graph Laplacian.
+ *
+ * Contents:
+ *   eigenvalues:  lambda_i, ascending [N]
+ *   eigenvectors: Q, row-major [N x N]; column k is eigenvector k
+ *
+ * Computed once, this answers any number of exp(-eta * L) * r queries
+ * without repeating the O(N^3) solve.
+ */
+struct SpectralDecomposition {
+    std::vector<double> eigenvalues;
+    Matrix eigenvectors;
+};
+
+/**
+ * @brief Compute the full symmetric eigendecomposition of a Laplacian.
+ *
+ * @param laplacian Graph Laplacian L [N x N].
+ * @param number_of_assets Number of assets (N).
+ * @return Eigenvalues and eigenvectors of L.
+ */
+SpectralDecomposition compute_spectral_decomposition(
+    const Matrix& laplacian,
+    uint32_t number_of_assets
+);
+
+/**
+ * @brief Diffuse returns using a precomputed factorization.
+ *
+ * Formula:
+ *   s_t = Q * exp(-eta * diag(lambda)) * Q^T * r_t
+ *
+ * @param decomposition Spectral factorization of L.
+ * @param latest_return Latest return vector r_t [N].
+ * @param number_of_assets Number of assets (N).
+ * @param diffusion_eta Diffusion parameter eta.
+ * @return Smoothed return vector s_t [N].
+ */
+Vector diffuse_returns_with_decomposition(
+    const SpectralDecomposition& decomposition,
+    const Vector& latest_return,
+    uint32_t number_of_assets,
+    double diffusion_eta
+);
+
+/**
+ * @brief Diffuse one return vector under several etas at once.
+ *
+ * Purpose:
+ *   Strain sensitivity bands (e.g. eta, eta/2, 2*eta daily) need
+ *   exp(-eta_k L) r on the identical Laplacian; running diffuse_returns
+ *   per eta repeats the O(N^3) eigendecomposition each time. This
+ *   entry point factorizes once, projects r once, and evaluates the
+ *   spectral filter exp(-eta_k * Lambda) per eta — each extra eta
+ *   costs one O(N^2) back-transform instead of a full solve.
+ *
+ * @param laplacian Graph Laplacian L [N x N].
+ * @param latest_return Latest return vector r_t [N].
+ * @param number_of_assets Number of assets (N).
+ * @param diffusion_etas Diffusion strengths, one per output (>= 1).
+ * @return One smoothed return vector [N] per eta, in input order.
+ */
+std::vector<Vector> diffuse_returns_multi_eta(
+    const Matrix& laplacian,
+    const Vector& latest_return,
+    uint32_t number_of_assets,
+    const std::vector<double>& diffusion_etas
+);
+
+/**
+ * @brief Save a spectral factorization to a binary sidecar.
+ *
+ * Purpose:
+ *   Let re-runs, recalibration, and research consumers skip the
+ *   O(N^3) eigensolve when the underlying Laplacian is unchanged.
+ *
+ * Binary layout:
+ *   - uint32: number of assets (N)
+ *   - uint64: caller-supplied key hash (e.g. of the Laplacian bytes
+ *             or of the source input file)
+ *   - double[N]: eigenvalues
+ *   - double[N * N]: eigenvectors (row-major)
+ *
+ * @param decomposition Factorization to save.
+ * @param number_of_assets Number of assets (N).
+ * @param key_hash Hash identifying the inputs this was computed from.
+ * @param output_path Path to write the binary file.
+ */
+void save_spectral_cache_bin(
+    const SpectralDecomposition& decomposition,
+    uint32_t number_of_assets,
+    uint64_t key_hash,
+    const std::string& output_path
+);
+
+/**
+ * @brief Load a spectral factorization from a binary sidecar.
+ *
+ * Callers compare out_key_hash against the hash of their current
+ * inputs and recompute when it differs.
+ *
+ * @param input_path Path to the binary file.
+ * @param out_number_of_assets Output: number of assets (N).
+ * @param out_key_hash Output: key hash stored at save time.
+ * @return Eigenvalues and eigenvectors.
+ */
+SpectralDecomposition load_spectral_cache_bin(
+    const std::string& input_path,
+    uint32_t& out_number_of_assets,
+    uint64_t& out_key_hash
+);
+
 /**
  * @brief Compute systemic smoothness ratio.
  *
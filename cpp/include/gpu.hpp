@@ -0,0 +1,82 @@
+#pragma once
+
+#include "types.hpp"
+#include "diffusion.hpp"
+
+#include <cstdint>
+
+/**
+ * @brief Optional CUDA offload for the dense linear algebra stages.
+ *
+ * Purpose:
+ *   At N=3000 the pipeline's dense cost is concentrated in two O(N^2 m)
+ *   / O(N^3) operations: the covariance rank-k update inside
+ *   compute_correlation and the Laplacian eigendecomposition inside
+ *   diffuse_returns / compute_spectral_decomposition. When the tree is
+ *   configured with -DMSI_WITH_CUDA=ON these are routed through cuBLAS
+ *   (DSYRK) and cuSOLVER (DSYEVD) behind the existing function
+ *   signatures; callers never see the backend.
+ *
+ * Selection is made at runtime: the GPU path is taken when the build
+ * has CUDA support, at least one device is present, and MSI_GPU is not
+ * set to "0". Device buffers and pinned host staging buffers are cached
+ * across calls, so batch backfills pay the allocation cost once.
+ *
+ * The O(N^2) elementwise transforms in graph.cpp / topology.cpp stay on
+ * the CPU: they are bandwidth-bound and already Eigen-vectorized, and
+ * shipping their inputs over PCIe costs more than computing them.
+ *
+ * These declarations are unconditional; the definitions live in
+ * src/gpu_cuda.cpp, which is only compiled when MSI_WITH_CUDA is ON.
+ * Call sites guard their GPU branches with #ifdef MSI_WITH_CUDA so the
+ * default build references none of these symbols.
+ */
+
+/**
+ * @brief Whether the CUDA backend can be used for this process.
+ *
+ * True when a CUDA device is present, handle creation succeeded, and
+ * the MSI_GPU environment variable is not "0". The probe runs once and
+ * the result is cached; a failed probe logs to stderr and permanently
+ * falls back to the CPU path rather than throwing.
+ */
+bool gpu_backend_available();
+
+/**
+ * @brief Covariance rank-k update on the GPU.
+ *
+ * Formula: C = scale * X^T * X for centered returns X [m x N], computed
+ * with cublasDsyrk on the lower triangle and mirrored on the host.
+ *
+ * @param centered_returns Centered return window [m x N], column-major
+ *                         (Eigen's default layout), length m*N.
+ * @param window_length Number of rows m.
+ * @param number_of_assets Number of assets (N).
+ * @param scale Scalar applied to the product (1/(m-1) for covariance).
+ * @param out_covariance Output buffer [N x N], length N*N, fully
+ *                       mirrored (symmetric, so row- vs column-major
+ *                       is immaterial).
+ */
+void gpu_compute_covariance(
+    const double* centered_returns,
+    uint32_t window_length,
+    uint32_t number_of_assets,
+    double scale,
+    double* out_covariance
+);
+
+/**
+ * @brief Full symmetric eigendecomposition of a Laplacian on the GPU.
+ *
+ * cusolverDnDsyevd; returns eigenvalues in ascending order and
+ * eigenvectors laid out exactly as compute_spectral_decomposition's
+ * CPU path (row-major, eigenvector k in column k).
+ *
+ * @param laplacian Graph Laplacian L [N x N], row-major.
+ * @param number_of_assets Number of assets (N).
+ * @return Eigenvalues and eigenvectors of L.
+ */
+SpectralDecomposition gpu_compute_spectral_decomposition(
+    const Matrix& laplacian,
+    uint32_t number_of_assets
+);
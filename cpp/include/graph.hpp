@@ -44,6 +44,151 @@ Matrix compute_laplacian(
     uint32_t number_of_assets
 );
 
+/**
+ * @brief Build weighted adjacency into a caller-provided buffer.
+ *
+ * Buffer-reusing variant of build_weighted_graph.
+ *
+ * @param correlation_matrix Correlation matrix [N x N].
+ * @param number_of_assets Number of assets (N).
+ * @param out_weighted_adjacency Output buffer, resized to [N x N].
+ */
+void build_weighted_graph_into(
+    const Matrix& correlation_matrix,
+    uint32_t number_of_assets,
+    Matrix& out_weighted_adjacency
+);
+
+/**
+ * @brief Compute the Laplacian in place, overwriting the adjacency.
+ *
+ * The adjacency matrix W is dead once L = D - W exists, so this variant
+ * reuses its buffer instead of allocating a second N x N matrix.
+ *
+ * @param weighted_adjacency In: adjacency W. Out: Laplacian L.
+ * @param number_of_assets Number of assets (N).
+ */
+void compute_laplacian_in_place(
+    Matrix& weighted_adjacency,
+    uint32_t number_of_assets
+);
+
+/**
+ * @brief Single-precision overloads (float32 compute mode).
+ *
+ * Identical semantics to the double kernels above, operating on MatrixF
+ * buffers: half the memory traffic and twice the SIMD lane width for
+ * the bandwidth-bound O(N^2) stages. The GTV overload still returns
+ * double so downstream strain arithmetic is unchanged.
+ */
+void build_weighted_graph_into(
+    const MatrixF& correlation_matrix,
+    uint32_t number_of_assets,
+    MatrixF& out_weighted_adjacency
+);
+
+void compute_laplacian_in_place(
+    MatrixF& weighted_adjacency,
+    uint32_t number_of_assets
+);
+
+double compute_graph_total_variation(
+    const VectorF& latest_return,
+    const MatrixF& laplacian,
+    uint32_t number_of_assets
+);
+
+/**
+ * @brief Packed-symmetric graph stages.
+ *
+ * W, like the correlation matrix it is derived from, is symmetric with
+ * a zero diagonal, so the packed variants store only the strictly-lower
+ * triangle: half the memory and half the traffic of the dense kernels,
+ * with bit-identical results. The Laplacian is emitted dense (the
+ * diffusion eigensolver consumes dense storage) directly from the
+ * packed adjacency, so no dense W is ever materialized.
+ */
+void build_weighted_graph_packed_into(
+    const PackedLowerMatrix& correlation_packed,
+    uint32_t number_of_assets,
+    PackedLowerMatrix& out_weighted_adjacency_packed
+);
+
+void compute_laplacian_from_packed_into(
+    const PackedLowerMatrix& weighted_adjacency_packed,
+    uint32_t number_of_assets,
+    Matrix& out_laplacian
+);
+
+/**
+ * @brief GTV from a packed adjacency: sum over stored (i > j) entries
+ *        of w_ij (r_i - r_j)^2, equal to r^T L r for the same graph.
+ */
+double compute_graph_total_variation_packed(
+    const Vector& latest_return,
+    const PackedLowerMatrix& weighted_adjacency_packed,
+    uint32_t number_of_assets
+);
+
+/**
+ * @brief Build a sparse weighted adjacency matrix from correlations.
+ *
+ * Purpose:
+ *   Drop weak edges so downstream Laplacian, GTV, and diffusion stages
+ *   can operate on a sparse graph instead of a dense N x N matrix.
+ *
+ * Rule:
+ *   An edge (i, j), i != j, is kept when its weight max(M_{ij}, 0)
+ *   exceeds weight_threshold. If top_k_neighbors > 0, an edge is
+ *   additionally required to rank within the top-k weights of at least
+ *   one of its endpoints (the kept set is symmetrized, so the result
+ *   is always a valid undirected graph).
+ *
+ * @param correlation_matrix Correlation matrix [N x N].
+ * @param number_of_assets Number of assets (N).
+ * @param weight_threshold Minimum edge weight to keep (>= 0).
+ * @param top_k_neighbors Keep top-k neighbors per asset; 0 disables.
+ * @return Sparse weighted adjacency matrix W in CSR form.
+ */
+SparseMatrixCSR build_weighted_graph_sparse(
+    const Matrix& correlation_matrix,
+    uint32_t number_of_assets,
+    double weight_threshold,
+    uint32_t top_k_neighbors
+);
+
+/**
+ * @brief Compute graph Laplacian from a sparse adjacency matrix.
+ *
+ * Formula:
+ *   L = D - W, stored in CSR form with explicit diagonal entries.
+ *
+ * @param weighted_adjacency Sparse adjacency matrix W (CSR).
+ * @param number_of_assets Number of assets (N).
+ * @return Sparse graph Laplacian L in CSR form.
+ */
+SparseMatrixCSR compute_laplacian_sparse(
+    const SparseMatrixCSR& weighted_adjacency,
+    uint32_t number_of_assets
+);
+
+/**
+ * @brief Compute graph total variation on a sparse Laplacian.
+ *
+ * Formula:
+ *   GTV = r_t^T L r_t, evaluated with one CSR matvec.
+ *
+ * @param latest_return Latest return vector r_t [N].
+ * @param laplacian Sparse graph Laplacian L (CSR).
+ * @param number_of_assets Number of assets (N).
+ * @return Scalar GTV value.
+ */
+double compute_graph_total_variation_sparse(
+    const Vector& latest_return,
+    const SparseMatrixCSR& laplacian,
+    uint32_t number_of_assets
+);
+
 /**
  * @brief Compute graph total variation (GTV).
  *
@@ -65,3 +210,29 @@ double compute_graph_total_variation(
     const Matrix& laplacian,
     uint32_t number_of_assets
 );
+
+/**
+ * @brief Compute GTV directly from the correlation matrix.
+ *
+ * Purpose:
+ *   Evaluate r^T L r without materializing the adjacency or Laplacian:
+ *   for the graph built by build_weighted_graph, the quadratic form
+ *   equals the weighted sum of squared return differences.
+ *
+ * Formula:
+ *   GTV = sum_{i<j} max(M_{ij}, 0) * (r_i - r_j)^2
+ *
+ * One streaming pass over the upper triangle of M; callers that only
+ * need the GTV number (e.g. a lightweight monitoring mode) can skip
+ * two full N x N materializations.
+ *
+ * @param latest_return Latest return vector r_t [N].
+ * @param correlation_matrix Correlation matrix M [N x N].
+ * @param number_of_assets Number of assets (N).
+ * @return Scalar GTV value.
+ */
+double compute_graph_total_variation_matrix_free(
+    const Vector& latest_return,
+    const Matrix& correlation_matrix,
+    uint32_t number_of_assets
+);
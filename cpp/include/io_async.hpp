@@ -0,0 +1,89 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "types.hpp"
+
+/**
+ * @brief Background writer for per-day binary artifacts.
+ *
+ * Purpose:
+ *   The ordered pipeline writes returns.bin (step 3), corr.bin (step 5)
+ *   and diagram.bin (step 13) synchronously, blocking the next compute
+ *   stage while tens of megabytes stream through std::ofstream. None of
+ *   these artifacts are read back within the same day, so the writes
+ *   can overlap the following compute stages: enqueue hands the buffer
+ *   to a single background I/O thread and returns immediately.
+ *
+ * Ownership:
+ *   enqueue_* takes its buffer by value. Call sites whose buffer is
+ *   dead after the write should std::move it in (no copy); buffers that
+ *   later stages still read (e.g. the correlation matrix) are passed by
+ *   copy — a memcpy is cheap next to an NFS write, and the overlap win
+ *   is unchanged.
+ *
+ * Errors:
+ *   Writes run on the background thread, so their exceptions cannot
+ *   propagate at the call site. The first failure is captured and
+ *   rethrown from the next wait_for_pending(); the destructor drains
+ *   the queue and reports any unretrieved failure to stderr instead of
+ *   throwing.
+ *
+ * Single background thread: writes are applied in enqueue order.
+ */
+struct AsyncArtifactWriter {
+    AsyncArtifactWriter();
+    ~AsyncArtifactWriter();
+
+    AsyncArtifactWriter(const AsyncArtifactWriter&) = delete;
+    AsyncArtifactWriter& operator=(const AsyncArtifactWriter&) = delete;
+
+    /// Queue a save_returns_bin write of the window returns [m x N].
+    void enqueue_returns_bin(
+        Matrix window_returns,
+        uint32_t number_of_assets,
+        uint32_t window_length,
+        std::string output_path
+    );
+
+    /// Queue a save_correlation_bin write of the matrix [N x N].
+    void enqueue_correlation_bin(
+        Matrix correlation_matrix,
+        uint32_t number_of_assets,
+        std::string output_path
+    );
+
+    /// Queue a save_diagram_bin write of the H1 diagram.
+    void enqueue_diagram_bin(
+        PersistenceDiagram diagram,
+        std::string output_path
+    );
+
+    /**
+     * @brief Block until every queued write has completed.
+     *
+     * Rethrows the first background write failure, if any. Call before
+     * reading any artifact back (e.g. the previous day's diagram during
+     * a batch run) and before process exit.
+     */
+    void wait_for_pending();
+
+private:
+    void enqueue_task(std::function<void()> write_task);
+    void worker_loop();
+
+    std::thread worker_thread;
+    std::mutex queue_mutex;
+    std::condition_variable queue_condition;
+    std::condition_variable drained_condition;
+    std::deque<std::function<void()>> pending_writes;
+    bool write_in_progress = false;
+    bool shutdown_requested = false;
+    std::exception_ptr first_failure;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "types.hpp"
+
+/**
+ * @brief Zero-copy view over a memory-mapped price cache file.
+ *
+ * Purpose:
+ *   Serve repeated reads of the same price matrix (backfills, tuning
+ *   sweeps) without paying the parquet decode each time. The view maps
+ *   the file read-only; data points directly into the mapping and stays
+ *   valid for the lifetime of the view.
+ *
+ * The view owns the mapping (move-only) and unmaps on destruction.
+ */
+struct PriceCacheView {
+    const double* data = nullptr;     ///< Row-major [rows x columns] prices
+    uint32_t number_of_rows = 0;
+    uint32_t number_of_columns = 0;
+    std::vector<std::string> tickers; ///< Column names; may be empty
+
+    PriceCacheView() = default;
+    PriceCacheView(const PriceCacheView&) = delete;
+    PriceCacheView& operator=(const PriceCacheView&) = delete;
+    PriceCacheView(PriceCacheView&& other) noexcept;
+    PriceCacheView& operator=(PriceCacheView&& other) noexcept;
+    ~PriceCacheView();
+
+    void* mapping_address = nullptr;  ///< mmap base (internal)
+    size_t mapping_size = 0;          ///< mmap length (internal)
+};
+
+/**
+ * @brief Write a binary price cache next to its parquet source.
+ *
+ * Binary layout:
+ *   - char[8]:  magic "MSICACHE"
+ *   - uint32:   format version (1)
+ *   - uint32:   number of rows (T)
+ *   - uint32:   number of columns (N)
+ *   - uint32:   reserved (0)
+ *   - double[T * N]: closing prices (row-major)
+ *   - uint32:   ticker count (0 if unknown)
+ *   - repeated (uint32 length, char[length]) ticker names
+ *
+ * @param closing_prices Price matrix to cache [T x N].
+ * @param number_of_rows Number of price rows (T).
+ * @param number_of_columns Number of assets (N).
+ * @param tickers Column names; pass empty if not available.
+ * @param cache_path Path to write the cache file.
+ */
+void write_close_prices_cache(
+    const Matrix& closing_prices,
+    uint32_t number_of_rows,
+    uint32_t number_of_columns,
+    const std::vector<std::string>& tickers,
+    const std::string& cache_path
+);
+
+/**
+ * @brief Memory-map an existing price cache file.
+ *
+ * @param cache_path Path to a file written by write_close_prices_cache.
+ * @return Zero-copy view over the mapped prices.
+ */
+PriceCacheView read_close_prices_cached(const std::string& cache_path);
+
+/**
+ * @brief Derive the cache path for a parquet input.
+ *
+ * Convention: sibling file with an appended ".mcache" suffix.
+ */
+std::string price_cache_path_for(const std::string& parquet_path);
+
+/**
+ * @brief FNV-1a 64-bit hash over a byte range.
+ *
+ * Used to key derived artifacts (e.g. spectral caches) to the exact
+ * bytes they were computed from.
+ */
+uint64_t compute_bytes_hash_fnv1a(const void* data, size_t size);
+
+/**
+ * @brief FNV-1a 64-bit hash over a whole file's contents.
+ *
+ * @param path Path to the file to hash.
+ * @return 64-bit content hash.
+ */
+uint64_t compute_file_hash_fnv1a(const std::string& path);
+
+/**
+ * @brief Read prices through the cache, building it on first use.
+ *
+ * If the cache file exists and is newer than the parquet source it is
+ * mapped directly; otherwise the parquet is decoded once, the cache is
+ * written, and the fresh cache is mapped.
+ *
+ * @param parquet_path Path to the prices_window.parquet file.
+ * @return Zero-copy view over the cached prices.
+ */
+PriceCacheView read_close_prices_cached_or_build(const std::string& parquet_path);
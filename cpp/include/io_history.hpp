@@ -0,0 +1,129 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Appendable strain-history and diagram-log files.
+ *
+ * Purpose:
+ *   write_strain_json leaves one ~300-byte JSON per day under
+ *   date=YYYY-MM-DD/; after a multi-year backfill, reading the history
+ *   means thousands of stats and parses, and finding yesterday's
+ *   persistence diagram means probing the filesystem date by date.
+ *   These helpers maintain two flat appendable files at the output
+ *   root, written alongside the per-day artifacts (which are
+ *   unchanged):
+ *
+ *     strain_history.bin  Fixed 88-byte records, one per day, holding
+ *                         every StrainComponents field plus the byte
+ *                         offset and length of that day's diagram in
+ *                         the diagram log. Five years of history is one
+ *                         ~120 KB sequential read.
+ *     diagrams.bin        Concatenated diagram records in exactly the
+ *                         per-day diagram.bin layout (uint32 pair
+ *                         count, then birth/death doubles), addressed
+ *                         by the offsets in the history records.
+ *
+ * Both files start with a magic/version header and grow by pure
+ * appends. Re-running a day appends a superseding record; readers must
+ * take the last record for a given date, and lookups here scan from
+ * the end for that reason.
+ */
+
+/// One fixed-size strain_history.bin record. Plain bytes on disk; the
+/// date is NUL-padded "YYYY-MM-DD".
+struct StrainHistoryRecord {
+    char date[16];
+    double l2_return_magnitude;
+    double graph_total_variation;
+    double systemic_ratio;
+    double total_persistence;
+    double wasserstein_distance;
+    double strain_index;
+    double normalized_strain_index;
+    uint64_t diagram_offset;     ///< Byte offset of the day's diagram in diagrams.bin
+    uint64_t diagram_byte_count; ///< Length of that diagram record (0 = not logged)
+};
+
+static_assert(sizeof(StrainHistoryRecord) == 88,
+              "strain_history.bin record layout changed");
+
+/**
+ * @brief Append one day's record to strain_history.bin.
+ *
+ * Creates the file with its header on first use; validates the header
+ * on subsequent appends.
+ *
+ * @param history_path Path to strain_history.bin.
+ * @param components The day's strain metrics.
+ * @param diagram_offset Offset returned by append_diagram_log.
+ * @param diagram_byte_count Length returned by append_diagram_log.
+ */
+void append_strain_history(
+    const std::string& history_path,
+    const StrainComponents& components,
+    uint64_t diagram_offset,
+    uint64_t diagram_byte_count
+);
+
+/**
+ * @brief Read the whole strain history in one sequential pass.
+ *
+ * @param history_path Path to strain_history.bin.
+ * @return All records in append order (duplicate dates possible; the
+ *         later record supersedes).
+ */
+std::vector<StrainHistoryRecord> read_strain_history(
+    const std::string& history_path
+);
+
+/**
+ * @brief Find the most recent record strictly before a date.
+ *
+ * Scans the file backwards so a superseding re-run of a day wins. The
+ * dates are YYYY-MM-DD, so lexicographic comparison is chronological.
+ *
+ * @param history_path Path to strain_history.bin.
+ * @param run_date Exclusive upper bound (the day being computed).
+ * @param out_record Filled with the match when found.
+ * @return True when a record before run_date exists. A missing history
+ *         file returns false rather than throwing, so fresh output
+ *         trees fall back to filesystem probing.
+ */
+bool find_latest_history_record_before(
+    const std::string& history_path,
+    const std::string& run_date,
+    StrainHistoryRecord& out_record
+);
+
+/**
+ * @brief Append one diagram to diagrams.bin.
+ *
+ * @param diagram_log_path Path to diagrams.bin.
+ * @param diagram The day's H1 diagram.
+ * @param out_byte_count Length of the appended record.
+ * @return Byte offset of the record, for the history row.
+ */
+uint64_t append_diagram_log(
+    const std::string& diagram_log_path,
+    const PersistenceDiagram& diagram,
+    uint64_t& out_byte_count
+);
+
+/**
+ * @brief Read one diagram record back from diagrams.bin by offset.
+ *
+ * @param diagram_log_path Path to diagrams.bin.
+ * @param diagram_offset Offset from a history record.
+ * @param diagram_byte_count Length from the same record.
+ * @return The diagram (one seek and one sequential read).
+ */
+PersistenceDiagram read_diagram_log_at(
+    const std::string& diagram_log_path,
+    uint64_t diagram_offset,
+    uint64_t diagram_byte_count
+);
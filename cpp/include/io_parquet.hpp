@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "types.hpp"
 
 /**
@@ -29,3 +30,44 @@ Matrix read_close_prices_parquet(
     uint32_t& out_number_of_rows,
     uint32_t& out_number_of_columns
 );
+
+/**
+ * @brief Read a closing-price parquet that may contain missing values.
+ *
+ * Purpose:
+ *   Ingest the raw warehouse export directly. Where the strict reader
+ *   throws on a null price, this variant records the cell as missing
+ *   (mask 0, price 0.0) and keeps reading, so pre-cleaning in Python
+ *   is no longer required. Non-finite stored values (NaN/inf) are
+ *   treated as missing as well.
+ *
+ * @param parquet_path Path to the prices_window.parquet file.
+ * @param out_number_of_rows Output: number of rows read.
+ * @param out_number_of_columns Output: number of columns read.
+ * @param out_valid Output validity mask, same [rows x cols] layout as
+ *        the returned matrix; 1 = observed, 0 = missing.
+ * @return Matrix of closing prices in row-major order, 0.0 at missing
+ *         cells.
+ */
+Matrix read_close_prices_parquet_masked(
+    const std::string& parquet_path,
+    uint32_t& out_number_of_rows,
+    uint32_t& out_number_of_columns,
+    ValidityMask& out_valid
+);
+
+/**
+ * @brief Read the ticker names of the price columns from a parquet file.
+ *
+ * Purpose:
+ *   Give callers (e.g. the sector preview mode) the ticker symbol for
+ *   each matrix column without decoding any price data. Applies the
+ *   same non-price-column skip rules as read_close_prices_parquet, so
+ *   the returned names align one-to-one with the matrix columns.
+ *
+ * @param parquet_path Path to the prices_window.parquet file.
+ * @return Ticker name per price column, in column order.
+ */
+std::vector<std::string> read_close_prices_column_names(
+    const std::string& parquet_path
+);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief NUMA placement and thread-affinity helpers for the pipeline.
+ *
+ * Purpose:
+ *   On dual-socket backfill machines the N x N workspace buffers
+ *   (~72 MB each at N=3000) are placed page by page on whichever socket
+ *   first touches them. A plain std::vector resize faults every page
+ *   from the calling thread, so the whole matrix lands on one node and
+ *   every bandwidth-bound O(N^2) kernel pays cross-socket traffic for
+ *   half its rows. These helpers (a) optionally pin the process to one
+ *   node's CPUs and (b) fault workspace pages under the same static
+ *   OpenMP partitioning the kernels use, so each thread's row block is
+ *   resident on its own socket.
+ *
+ * Implemented directly against /sys and sched_setaffinity rather than
+ * libnuma, which is not a dependency of this tree.
+ */
+
+/**
+ * @brief Pin the calling thread (and OpenMP workers created after it)
+ *        to the CPUs of one NUMA node.
+ *
+ * Parses /sys/devices/system/node/node<K>/cpulist and applies the CPU
+ * set with sched_setaffinity. Must run before the first parallel
+ * region so worker threads inherit the mask.
+ *
+ * @param numa_node Node index (the K in nodeK).
+ * @return Number of CPUs in the node's cpulist.
+ * @throws std::runtime_error if the node does not exist or the
+ *         affinity call fails (or on non-Linux platforms).
+ */
+uint32_t pin_threads_to_numa_node(uint32_t numa_node);
+
+/**
+ * @brief Best-effort madvise(MADV_HUGEPAGE) on a buffer.
+ *
+ * Rounds the range inward to page boundaries and ignores failures;
+ * transparent huge pages cut TLB misses on the 72 MB matrices but are
+ * purely an optimization.
+ */
+void advise_huge_pages(void* data, size_t size_in_bytes);
+
+/**
+ * @brief Resize a workspace buffer with parallel first-touch placement.
+ *
+ * When the buffer must grow, the storage is reallocated, advised for
+ * huge pages, and prefaulted in contiguous per-thread slices — each
+ * OpenMP thread asks the kernel to populate its own share of the
+ * range, matching the static split the row-parallel kernels use — so
+ * each thread's share of the matrix is placed on that thread's own
+ * node. When capacity already suffices this is an ordinary resize;
+ * page placement is fixed at first fault and later writes do not
+ * move it.
+ */
+void first_touch_resize(Matrix& buffer, size_t element_count);
+void first_touch_resize(MatrixF& buffer, size_t element_count);
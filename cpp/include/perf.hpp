@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "types.hpp"
+
+/**
+ * @brief Wall time and memory footprint of one pipeline stage.
+ *
+ * peak_rss_delta_kb is the growth of the process peak RSS across the
+ * stage (ru_maxrss); it is 0 for stages that fit in already-reserved
+ * memory and positive for the stage that pushed the high-water mark.
+ */
+struct StageTiming {
+    std::string stage_name;
+    double wall_time_ms;
+    long peak_rss_delta_kb;
+};
+
+/**
+ * @brief Per-day performance report written as perf.json.
+ *
+ * Purpose:
+ *   Record stage latencies and key problem sizes next to strain.json
+ *   so nightly-job slowdowns can be attributed (Ripser vs eigensolver
+ *   vs parquet decode) without rebuilding with a profiler.
+ */
+struct PerfReport {
+    std::string date;
+    uint32_t number_of_assets = 0;
+    uint32_t window_length = 0;
+    uint32_t diagram_pair_count = 0;
+    std::vector<StageTiming> stages;
+};
+
+/**
+ * @brief Scoped timer: measures from construction to destruction and
+ *        appends one StageTiming to the report.
+ *
+ * Usage:
+ *   {
+ *       ScopedStageTimer timer(report, "compute_persistence_H1");
+ *       diagram = compute_persistence_H1(...);
+ *   }
+ */
+class ScopedStageTimer {
+public:
+    ScopedStageTimer(PerfReport& report, const std::string& stage_name);
+    ~ScopedStageTimer();
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    PerfReport& report_;
+    std::string stage_name_;
+    std::chrono::steady_clock::time_point start_time_;
+    long peak_rss_before_kb_;
+};
+
+/**
+ * @brief Current process peak RSS in kilobytes (ru_maxrss).
+ */
+long current_peak_rss_kb();
+
+/**
+ * @brief Write the performance report to a JSON file.
+ *
+ * Layout mirrors write_strain_json: top-level scalars for the problem
+ * sizes, plus a "stages" array of {stage, wall_time_ms,
+ * peak_rss_delta_kb} objects in execution order.
+ *
+ * @param report Performance report to write.
+ * @param output_path Path to write the JSON file.
+ */
+void write_perf_json(
+    const PerfReport& report,
+    const std::string& output_path
+);
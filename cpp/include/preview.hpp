@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "types.hpp"
+
+/**
+ * @brief Asset-to-sector assignment for the coarse preview mode.
+ *
+ * Purpose:
+ *   Map each of the N universe assets onto one of K sectors/clusters
+ *   (K ~ 50) so the correlation matrix can be aggregated into a K x K
+ *   block matrix and the downstream pipeline run at preview cost.
+ *
+ * Contents:
+ *   sector_of_asset: sector index for each asset column [N]
+ *   sector_names:    sector label per index [K]
+ */
+struct SectorMapping {
+    uint32_t number_of_sectors;
+    std::vector<uint32_t> sector_of_asset;
+    std::vector<std::string> sector_names;
+};
+
+/**
+ * @brief Load a ticker-to-sector mapping CSV.
+ *
+ * Expected format (header optional): one "ticker,sector" pair per
+ * line, matching the universe tickers in data/universe.csv. Tickers
+ * present in the universe but absent from the CSV are grouped into a
+ * synthetic "UNMAPPED" sector so a stale mapping degrades gracefully
+ * instead of failing the preview.
+ *
+ * @param csv_path Path to the mapping CSV.
+ * @param tickers Universe ticker per asset column, in column order [N].
+ * @return Sector mapping with one entry per asset column.
+ */
+SectorMapping load_sector_mapping_csv(
+    const std::string& csv_path,
+    const std::vector<std::string>& tickers
+);
+
+/**
+ * @brief Aggregate an N x N correlation matrix into K x K sector blocks.
+ *
+ * Formula:
+ *   M'_{ab} = mean over (i in a, j in b, i != j) of M_{ij}
+ *   M'_{aa} diagonal forced to exactly 1 (a sector is fully correlated
+ *   with itself at preview granularity).
+ *
+ * Empty blocks (sectors with no cross pairs) aggregate to 0.
+ *
+ * @param correlation_matrix Full correlation matrix [N x N].
+ * @param number_of_assets Number of assets (N).
+ * @param mapping Asset-to-sector mapping.
+ * @return Sector-level correlation matrix [K x K].
+ */
+Matrix aggregate_correlation_by_sector(
+    const Matrix& correlation_matrix,
+    uint32_t number_of_assets,
+    const SectorMapping& mapping
+);
+
+/**
+ * @brief Aggregate a per-asset vector into per-sector means.
+ *
+ * Used for the latest-return vector: r'_a = mean over i in a of r_i.
+ *
+ * @param values Per-asset values [N].
+ * @param number_of_assets Number of assets (N).
+ * @param mapping Asset-to-sector mapping.
+ * @return Per-sector means [K].
+ */
+Vector aggregate_vector_by_sector(
+    const Vector& values,
+    uint32_t number_of_assets,
+    const SectorMapping& mapping
+);
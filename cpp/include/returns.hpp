@@ -25,6 +25,57 @@ Returns compute_log_returns(
     uint32_t window_length
 );
 
+/**
+ * @brief Compute log returns into a caller-provided Returns struct.
+ *
+ * Identical to compute_log_returns, but reuses the buffers already in
+ * out_returns (resized if needed) so batch callers do not reallocate
+ * the m x N window every day. The latest-return extraction is fused
+ * into the same pass over the price rows.
+ *
+ * @param closing_prices Dense matrix of closing prices [(m+1) x N].
+ * @param number_of_assets Number of assets (N).
+ * @param window_length Number of return rows in the window (m).
+ * @param out_returns Output struct; window_returns resized to [m x N],
+ *        latest_return resized to [N].
+ */
+void compute_log_returns_into(
+    const Matrix& closing_prices,
+    uint32_t number_of_assets,
+    uint32_t window_length,
+    Returns& out_returns
+);
+
+/**
+ * @brief Compute log returns from prices with missing observations.
+ *
+ * Purpose:
+ *   Ingest the raw warehouse price matrix directly: halts, late
+ *   listings, and delistings arrive as masked-out cells instead of
+ *   forcing whole columns to be dropped upstream.
+ *
+ * Formula:
+ *   r_{t,i} = log(P_{t,i} / P_{t-1,i}) where both prices are observed
+ *   and positive; masked out (and set to 0.0, so unmasked consumers
+ *   see a neutral value) otherwise.
+ *
+ * @param closing_prices Dense matrix of closing prices [(m+1) x N].
+ * @param price_valid Validity mask for closing_prices, same layout.
+ * @param number_of_assets Number of assets (N).
+ * @param window_length Number of return rows in the window (m).
+ * @param out_returns Output struct; window_returns resized to [m x N],
+ *        latest_return resized to [N] (0.0 where masked).
+ * @param out_return_valid Validity mask for window_returns [m x N].
+ */
+void compute_log_returns_masked_into(
+    const Matrix& closing_prices,
+    const ValidityMask& price_valid,
+    uint32_t number_of_assets,
+    uint32_t window_length,
+    Returns& out_returns,
+    ValidityMask& out_return_valid
+);
+
 /**
  * @brief Save rolling-window returns to a binary file.
  *
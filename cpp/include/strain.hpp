@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include "types.hpp"
 
@@ -67,3 +68,63 @@ void write_strain_json(
     const StrainComponents& result,
     const std::string& output_path
 );
+
+/**
+ * @brief Running moments of the strain index in Welford form.
+ *
+ * Purpose:
+ *   Keep the z-score normalization self-maintaining: one O(1) update
+ *   per day instead of a periodic re-scan of every historical
+ *   strain.json to recalibrate pinned mean/std constants.
+ *
+ * Formula (Welford):
+ *   count += 1
+ *   delta  = x - mean;          mean += delta / count
+ *   m2    += delta * (x - mean)
+ *   population std = sqrt(m2 / count)
+ *
+ * The last folded-in date makes the update idempotent: re-running a
+ * day (or replaying out of order) refreshes its output without
+ * double-counting the sample.
+ */
+struct NormalizationState {
+    uint64_t count = 0;     ///< Number of daily samples folded in
+    double mean = 0.0;      ///< Running mean of the strain index
+    double m2 = 0.0;        ///< Running sum of squared deviations
+    std::string last_date;  ///< Most recent date folded in (YYYY-MM-DD)
+};
+
+/**
+ * @brief Fold one day's strain index into the running moments.
+ *
+ * Dates at or before last_date are skipped (idempotent re-runs).
+ *
+ * @param state State to update in place.
+ * @param strain_index The day's (unnormalized) strain index.
+ * @param run_date The day's date, YYYY-MM-DD.
+ */
+void update_normalization_state(
+    NormalizationState& state,
+    double strain_index,
+    const std::string& run_date
+);
+
+/**
+ * @brief Population standard deviation of the state (0 when count < 2).
+ */
+double normalization_state_std_pop(const NormalizationState& state);
+
+/**
+ * @brief Load the normalization state file; a missing file yields an
+ *        empty state (the normal start of a fresh output tree).
+ */
+NormalizationState load_normalization_state_bin(const std::string& input_path);
+
+/**
+ * @brief Persist the normalization state (magic/version header, then
+ *        count, mean, M2, last date).
+ */
+void save_normalization_state_bin(
+    const NormalizationState& state,
+    const std::string& output_path
+);
@@ -23,6 +23,63 @@ Matrix correlation_to_distance(
     uint32_t number_of_assets
 );
 
+/**
+ * @brief Convert correlations to distances in a caller-provided buffer.
+ *
+ * Buffer-reusing variant of correlation_to_distance.
+ *
+ * @param correlation_matrix Correlation matrix M [N x N].
+ * @param number_of_assets Number of assets (N).
+ * @param out_distance_matrix Output buffer, resized to [N x N].
+ */
+void correlation_to_distance_into(
+    const Matrix& correlation_matrix,
+    uint32_t number_of_assets,
+    Matrix& out_distance_matrix
+);
+
+/**
+ * @brief Single-precision distance conversion (float32 compute mode).
+ *
+ * Same formula and clamping as the double kernel, on MatrixF buffers.
+ */
+void correlation_to_distance_into(
+    const MatrixF& correlation_matrix,
+    uint32_t number_of_assets,
+    MatrixF& out_distance_matrix
+);
+
+/**
+ * @brief Packed distance conversion for the packed-symmetric mode.
+ *
+ * Applies the same formula and clamps as the dense kernel to each
+ * stored strictly-lower entry (the zero diagonal is implicit), and
+ * emits float: Ripser's internal value type is float, and its
+ * lower-distance-matrix layout is exactly this packed layout, so the
+ * output buffer can be moved into compute_persistence_H1_packed with
+ * no copy.
+ */
+void correlation_to_distance_packed_into(
+    const PackedLowerMatrix& correlation_packed,
+    uint32_t number_of_assets,
+    PackedLowerMatrixF& out_distance_packed
+);
+
+/**
+ * @brief H1 persistence from a packed float distance matrix.
+ *
+ * Takes the buffer by value: pass with std::move and the packed floats
+ * are handed to Ripser as-is — no lower-triangle extraction pass and no
+ * N*N/2 copy, unlike the dense overloads. Threshold semantics match
+ * compute_persistence_H1 (0 = auto enclosing radius, > 0 explicit,
+ * < 0 uncapped).
+ */
+PersistenceDiagram compute_persistence_H1_packed(
+    PackedLowerMatrixF distance_packed,
+    uint32_t number_of_assets,
+    double distance_threshold
+);
+
 /**
  * @brief Compute H1 persistence diagram from distance matrix.
  *
@@ -40,6 +97,92 @@ PersistenceDiagram compute_persistence_H1(
     uint32_t number_of_assets
 );
 
+/**
+ * @brief Compute H1 persistence diagram with a filtration cutoff.
+ *
+ * Purpose:
+ *   Bound the Vietoris-Rips cofacet enumeration. Above the enclosing
+ *   radius (min over i of max over j of d_ij) the complex is a cone,
+ *   so no finite H1 pair can be born or die there; cutting the
+ *   filtration at that radius yields the identical diagram while
+ *   skipping the bulk of the edge enumeration on dense regimes.
+ *
+ * @param distance_matrix Distance matrix [N x N].
+ * @param number_of_assets Number of assets (N).
+ * @param distance_threshold Filtration cutoff. 0 selects the enclosing
+ *        radius automatically (recommended); a positive value is used
+ *        as-is (pairs beyond it are dropped); a negative value disables
+ *        the cutoff and enumerates the full filtration.
+ * @return Persistence diagram (birth-death pairs).
+ *
+ * Paper reference: Section 4 (H1 features)
+ */
+PersistenceDiagram compute_persistence_H1(
+    const Matrix& distance_matrix,
+    uint32_t number_of_assets,
+    double distance_threshold
+);
+
+/**
+ * @brief Single-precision H1 persistence (float32 compute mode).
+ *
+ * Ripser's internal value_t is float, so feeding a MatrixF distance
+ * matrix skips the narrowing copy the double overload performs; the
+ * resulting diagram is identical up to float rounding of the inputs.
+ */
+PersistenceDiagram compute_persistence_H1(
+    const MatrixF& distance_matrix,
+    uint32_t number_of_assets,
+    double distance_threshold
+);
+
+/**
+ * @brief Incremental H1 persistence seeded by the previous day's diagram.
+ *
+ * Purpose:
+ *   Consecutive trading days differ by one sliding-window day, so the
+ *   diagram drifts slowly. Instead of re-reducing the full filtration,
+ *   cap it at (previous max death) * (1 + threshold_margin): Ripser's
+ *   cofacet enumeration grows superlinearly with the cutoff, so on calm
+ *   days the reduction touches a small fraction of the simplices.
+ *
+ * Exactness:
+ *   If the capped run reports any H1 class still alive at the cap, the
+ *   cap clipped the diagram and the computation falls back to the full
+ *   enclosing-radius run, so drifting deaths are always recovered
+ *   exactly. The one case the fallback cannot see is a class born
+ *   entirely above the cap — a brand-new loop at scales beyond anything
+ *   in yesterday's diagram — which is what threshold_margin is sized to
+ *   absorb. Callers needing a hard guarantee should keep the plain
+ *   compute_persistence_H1 path.
+ *
+ * Falls back to the full run when the previous diagram is empty or the
+ * cap is not below the enclosing radius (no work to save).
+ *
+ * @param distance_matrix Distance matrix [N x N].
+ * @param number_of_assets Number of assets (N).
+ * @param previous_diagram Previous day's H1 diagram.
+ * @param threshold_margin Relative headroom above the previous max
+ *        death (>= 0), e.g. 0.25 caps at 1.25x.
+ * @return Persistence diagram (birth-death pairs).
+ */
+PersistenceDiagram compute_persistence_H1_warm_start(
+    const Matrix& distance_matrix,
+    uint32_t number_of_assets,
+    const PersistenceDiagram& previous_diagram,
+    double threshold_margin
+);
+
+/**
+ * @brief Single-precision warm-started H1 persistence.
+ */
+PersistenceDiagram compute_persistence_H1_warm_start(
+    const MatrixF& distance_matrix,
+    uint32_t number_of_assets,
+    const PersistenceDiagram& previous_diagram,
+    double threshold_margin
+);
+
 /**
  * @brief Compute total persistence of a diagram.
  *
@@ -103,3 +246,37 @@ double compute_wasserstein_distance(
     const PersistenceDiagram& current_diagram,
     const PersistenceDiagram& previous_diagram
 );
+
+/**
+ * @brief Compute Wasserstein distance with an approximation budget.
+ *
+ * Purpose:
+ *   Bound the auction matching cost on large diagrams. Volatile
+ *   regimes produce thousands of near-diagonal H1 pairs that dominate
+ *   the exact auction superlinearly while contributing almost nothing
+ *   to the W1 distance.
+ *
+ * Controls:
+ *   - lifetime_epsilon: pairs with death - birth < epsilon are pruned
+ *     from both diagrams before matching. Each pruned pair changes W1
+ *     by at most epsilon / 2 (its diagonal-projection cost), so the
+ *     total error is bounded by epsilon / 2 times the pruned count.
+ *     0 disables pruning.
+ *   - relative_error_delta: hera's auction relative-error parameter
+ *     (params.delta); larger values trade bounded relative error for
+ *     speed. 0 keeps hera's exact default.
+ *
+ * The 2-argument overload is equivalent to (0, 0): exact matching.
+ *
+ * @param current_diagram Current day's persistence diagram.
+ * @param previous_diagram Previous day's persistence diagram.
+ * @param lifetime_epsilon Minimum lifetime to keep a pair (>= 0).
+ * @param relative_error_delta Auction relative error (>= 0).
+ * @return Scalar Wasserstein distance.
+ */
+double compute_wasserstein_distance(
+    const PersistenceDiagram& current_diagram,
+    const PersistenceDiagram& previous_diagram,
+    double lifetime_epsilon,
+    double relative_error_delta
+);
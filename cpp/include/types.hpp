@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -26,6 +27,111 @@ using Matrix = std::vector<double>;
  */
 using Vector = std::vector<double>;
 
+/**
+ * @brief Per-cell validity mask for matrices with missing data.
+ *
+ * Same row-major flat layout as the Matrix it annotates; 1 = observed,
+ * 0 = missing (halted, not yet listed, delisted). One byte per cell
+ * rather than a packed bitset: the mask-aware kernels consume the mask
+ * as an arithmetic 0/1 operand of matrix products, so bytes widen for
+ * free while bits would need an unpack pass.
+ */
+using ValidityMask = std::vector<uint8_t>;
+
+/**
+ * @brief Scalar-parameterized dense matrix / vector storage.
+ *
+ * Same row-major flat layout as Matrix / Vector, but generic over the
+ * element type for the single-precision compute mode. MatrixT<double>
+ * is layout-identical to Matrix.
+ */
+template <typename Scalar>
+using MatrixT = std::vector<Scalar>;
+
+template <typename Scalar>
+using VectorT = std::vector<Scalar>;
+
+/**
+ * @brief Single-precision matrix / vector (float32 compute mode).
+ *
+ * Used by the O(N^2) kernels when daily_run is invoked with
+ * --precision float32: half the memory traffic and twice the SIMD
+ * lane width of the double path. Ripser narrows to float internally
+ * anyway, so the distance -> persistence hand-off loses nothing.
+ */
+using MatrixF = MatrixT<float>;
+using VectorF = VectorT<float>;
+
+/**
+ * @brief Packed strictly-lower-triangle storage for a symmetric matrix.
+ *
+ * Convention:
+ *   Element (i, j) with i > j lives at flat index i*(i-1)/2 + j; rows
+ *   are stored in order (row 1 has one entry, row 2 has two, ...). The
+ *   diagonal is implicit: 0 for distance and adjacency matrices, 1 for
+ *   correlation matrices.
+ *
+ * This is exactly Ripser's lower-distance-matrix layout, so a packed
+ * float distance buffer can be handed to the persistence stage by move
+ * with no copy. Memory is N*(N-1)/2 entries instead of N*N.
+ */
+template <typename Scalar>
+using PackedLowerMatrixT = std::vector<Scalar>;
+
+using PackedLowerMatrix = PackedLowerMatrixT<double>;
+using PackedLowerMatrixF = PackedLowerMatrixT<float>;
+
+/// Number of strictly-lower-triangle entries of an N x N matrix.
+inline size_t packed_lower_entry_count(uint32_t number_of_assets) {
+    const size_t n = static_cast<size_t>(number_of_assets);
+    return (n * (n - 1)) / 2;
+}
+
+/// Flat packed index of element (i, j). Requires i > j.
+inline size_t packed_lower_index(uint32_t i, uint32_t j) {
+    return (static_cast<size_t>(i) * (static_cast<size_t>(i) - 1)) / 2 +
+           static_cast<size_t>(j);
+}
+
+/**
+ * @brief Extract the strictly-lower triangle of a dense symmetric
+ *        matrix into packed storage.
+ */
+template <typename Scalar>
+inline void pack_lower_into(
+    const MatrixT<Scalar>& dense_matrix,
+    uint32_t number_of_assets,
+    PackedLowerMatrixT<Scalar>& out_packed
+) {
+    out_packed.resize(packed_lower_entry_count(number_of_assets));
+    size_t packed_index = 0;
+    for (uint32_t i = 1; i < number_of_assets; ++i) {
+        const Scalar* row =
+            dense_matrix.data() + static_cast<size_t>(i) * number_of_assets;
+        for (uint32_t j = 0; j < i; ++j) {
+            out_packed[packed_index++] = row[j];
+        }
+    }
+}
+
+/**
+ * @brief Sparse matrix in compressed sparse row (CSR) form.
+ *
+ * Convention:
+ *   - row_offsets has N+1 entries; row i occupies
+ *     [row_offsets[i], row_offsets[i+1]) in column_indices/values.
+ *   - Column indices within a row are strictly increasing.
+ *
+ * Used for:
+ *   - Thresholded weighted adjacency matrices
+ *   - Sparse graph Laplacians
+ */
+struct SparseMatrixCSR {
+    std::vector<size_t> row_offsets;
+    std::vector<uint32_t> column_indices;
+    std::vector<double> values;
+};
+
 /**
  * @brief Persistence pair storing birth and death times.
  *
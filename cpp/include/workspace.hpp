@@ -0,0 +1,37 @@
+#pragma once
+
+#include "types.hpp"
+
+/**
+ * @brief Reusable buffers for one pipeline pass.
+ *
+ * Purpose:
+ *   Each pipeline stage normally returns a freshly allocated N x N
+ *   matrix; at N=3000 that is five-plus 72 MB allocations per day. A
+ *   Workspace owns those buffers once and the *_into / *_in_place stage
+ *   variants write into them, so batch backfills touch the same hot
+ *   memory day after day.
+ *
+ * Buffers are sized on first use by the stage functions and keep their
+ * capacity across days.
+ */
+struct Workspace {
+    Matrix correlation;   ///< Correlation matrix [N x N]
+    Matrix graph;         ///< Adjacency W, overwritten in place by L = D - W
+    Matrix distance;      ///< Distance matrix [N x N]
+    Matrix window_returns;///< Rolling return window [m x N]
+
+    // Single-precision counterparts, used only by the float32 compute
+    // mode (--precision float32); empty otherwise.
+    MatrixF correlation_f;///< float32 copy of the correlation matrix
+    MatrixF graph_f;      ///< float32 adjacency, overwritten by the Laplacian
+    MatrixF distance_f;   ///< float32 distance matrix
+
+    // Packed strictly-lower-triangle buffers, used only by the
+    // packed-symmetric mode (--packed 1); empty otherwise. The packed
+    // distance buffer is float and is moved into Ripser each day, so it
+    // reallocates per day by design (no copy beats buffer reuse there).
+    PackedLowerMatrix correlation_packed; ///< Packed correlation [N*(N-1)/2]
+    PackedLowerMatrix graph_packed;       ///< Packed adjacency W
+    PackedLowerMatrixF distance_packed;   ///< Packed float distances for Ripser
+};
@@ -1,14 +1,75 @@
 #include "correlation.hpp"
 
+#ifdef MSI_WITH_CUDA
+#include "gpu.hpp"
+#endif
+
 #include <Eigen/Dense>
 #include <fstream>
 #include <stdexcept>
 #include <cmath>
 
+using RowMajorMatrixXd =
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+/**
+ * @brief Normalize a covariance matrix into correlation form.
+ *
+ * Shared by the full and rolling paths: M_{ij} = Cov(i,j)/(std_i std_j)
+ * with the zero-variance guard and exact unit diagonal. Expressed as an
+ * outer-product scaling M = Cov .* (v v^T) with v_i = 1/std_i (0 for
+ * degenerate assets), vectorized per row and threaded with OpenMP.
+ */
+static void normalize_covariance_into(
+    const Eigen::MatrixXd& covariance_matrix,
+    uint32_t number_of_assets,
+    Matrix& out_correlation
+) {
+    // 1/std_i, with the zero-variance guard folded in: a degenerate
+    // asset gets v_i = 0, which zeroes its whole row and column before
+    // the diagonal is forced back to 1.
+    Eigen::VectorXd inverse_standard_deviations =
+        covariance_matrix.diagonal().array().sqrt().unaryExpr(
+            [](double standard_deviation) {
+                return standard_deviation > 1e-10 ? 1.0 / standard_deviation : 0.0;
+            }
+        );
+
+    out_correlation.resize(static_cast<size_t>(number_of_assets) * number_of_assets);
+    Eigen::Map<RowMajorMatrixXd> correlation(
+        out_correlation.data(), number_of_assets, number_of_assets);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int i = 0; i < static_cast<int>(number_of_assets); ++i) {
+        correlation.row(i) =
+            inverse_standard_deviations(i) *
+            covariance_matrix.row(i).cwiseProduct(
+                inverse_standard_deviations.transpose()
+            );
+    }
+
+    // Ensure diagonal is exactly 1.0 (numerical precision, and restores
+    // the zero-variance convention M_{ii} = 1).
+    correlation.diagonal().setOnes();
+}
+
 Matrix compute_correlation(
     const Matrix& returns,
     uint32_t number_of_assets,
     uint32_t window_length
+) {
+    Matrix result;
+    compute_correlation_into(returns, number_of_assets, window_length, result);
+    return result;
+}
+
+void compute_correlation_into(
+    const Matrix& returns,
+    uint32_t number_of_assets,
+    uint32_t window_length,
+    Matrix& out_correlation
 ) {
     // Validate inputs
     size_t expected_size = static_cast<size_t>(window_length) * number_of_assets;
@@ -35,48 +96,175 @@ Matrix compute_correlation(
     Eigen::MatrixXd centered_returns = return_matrix.rowwise() - asset_means.transpose();
 
     // Step 3: Compute covariance matrix
-    // Cov = (1/(m-1)) * X^T * X where X is the centered data
-    // Using Eigen's efficient matrix multiplication
-    Eigen::MatrixXd covariance_matrix = (centered_returns.transpose() * centered_returns) 
-                                        / (window_length - 1);
+    // Cov = (1/(m-1)) * X^T * X where X is the centered data.
+    // The product is symmetric, so use a rank-k (SYRK) update on the
+    // lower triangle — half the FLOPs of the general product — and
+    // mirror it into the upper triangle afterwards.
+#ifdef MSI_WITH_CUDA
+    if (gpu_backend_available()) {
+        Eigen::MatrixXd covariance_matrix(number_of_assets, number_of_assets);
+        gpu_compute_covariance(
+            centered_returns.data(), window_length, number_of_assets,
+            1.0 / (window_length - 1), covariance_matrix.data());
+        normalize_covariance_into(covariance_matrix, number_of_assets, out_correlation);
+        return;
+    }
+#endif
+    Eigen::MatrixXd covariance_matrix =
+        Eigen::MatrixXd::Zero(number_of_assets, number_of_assets);
+    covariance_matrix.selfadjointView<Eigen::Lower>().rankUpdate(
+        centered_returns.transpose(),
+        1.0 / (window_length - 1)
+    );
+    covariance_matrix.triangularView<Eigen::StrictlyUpper>() =
+        covariance_matrix.transpose();
 
-    // Step 4: Compute standard deviations (sqrt of diagonal of covariance)
-    Eigen::VectorXd standard_deviations = covariance_matrix.diagonal().array().sqrt();
+    // Steps 4-5: normalize into correlation form (shared helper)
+    normalize_covariance_into(covariance_matrix, number_of_assets, out_correlation);
+}
 
-    // Step 5: Compute correlation matrix
-    // M_{ij} = Cov(i,j) / (std_i * std_j)
-    Eigen::MatrixXd correlation_matrix(number_of_assets, number_of_assets);
+void compute_correlation_packed_into(
+    const Matrix& returns,
+    uint32_t number_of_assets,
+    uint32_t window_length,
+    PackedLowerMatrix& out_correlation_packed
+) {
+    size_t expected_size = static_cast<size_t>(window_length) * number_of_assets;
+    if (returns.size() != expected_size) {
+        throw std::runtime_error("returns size mismatch: expected " +
+                                 std::to_string(expected_size) +
+                                 ", got " + std::to_string(returns.size()));
+    }
 
-    for (uint32_t i = 0; i < number_of_assets; ++i) {
-        for (uint32_t j = 0; j < number_of_assets; ++j) {
-            double denominator = standard_deviations(i) * standard_deviations(j);
-            
-            if (denominator > 1e-10) {
-                correlation_matrix(i, j) = covariance_matrix(i, j) / denominator;
-            } else {
-                // Handle zero variance case
-                correlation_matrix(i, j) = (i == j) ? 1.0 : 0.0;
+    if (window_length < 2) {
+        throw std::runtime_error("window_length must be at least 2 for correlation");
+    }
+
+    Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+        return_matrix(returns.data(), window_length, number_of_assets);
+
+    Eigen::VectorXd asset_means = return_matrix.colwise().mean();
+    Eigen::MatrixXd centered_returns = return_matrix.rowwise() - asset_means.transpose();
+
+    // SYRK on the lower triangle, as in compute_correlation_into; the
+    // packed output never needs the upper mirror, so it is skipped.
+    Eigen::MatrixXd covariance_matrix =
+        Eigen::MatrixXd::Zero(number_of_assets, number_of_assets);
+    covariance_matrix.selfadjointView<Eigen::Lower>().rankUpdate(
+        centered_returns.transpose(),
+        1.0 / (window_length - 1)
+    );
+
+    Eigen::VectorXd inverse_standard_deviations =
+        covariance_matrix.diagonal().array().sqrt().unaryExpr(
+            [](double standard_deviation) {
+                return standard_deviation > 1e-10 ? 1.0 / standard_deviation : 0.0;
             }
+        );
+
+    // Normalize straight into packed storage: the unit diagonal is
+    // implicit, so only the strictly-lower entries are written.
+    out_correlation_packed.resize(packed_lower_entry_count(number_of_assets));
+    for (uint32_t i = 1; i < number_of_assets; ++i) {
+        double* packed_row =
+            out_correlation_packed.data() + packed_lower_index(i, 0);
+        const double inverse_std_i = inverse_standard_deviations(i);
+        for (uint32_t j = 0; j < i; ++j) {
+            packed_row[j] =
+                inverse_std_i * inverse_standard_deviations(j) * covariance_matrix(i, j);
         }
     }
+}
 
-    // Ensure diagonal is exactly 1.0 (numerical precision)
-    for (uint32_t i = 0; i < number_of_assets; ++i) {
-        correlation_matrix(i, i) = 1.0;
+RollingCorrelationState init_rolling_correlation(
+    const Matrix& returns,
+    uint32_t number_of_assets,
+    uint32_t window_length
+) {
+    size_t expected_size = static_cast<size_t>(window_length) * number_of_assets;
+    if (returns.size() != expected_size) {
+        throw std::runtime_error("returns size mismatch: expected " +
+                                 std::to_string(expected_size) +
+                                 ", got " + std::to_string(returns.size()));
     }
 
-    // Convert Eigen matrix back to our flat vector format (row-major)
-    Matrix result(number_of_assets * number_of_assets);
-    for (uint32_t i = 0; i < number_of_assets; ++i) {
-        for (uint32_t j = 0; j < number_of_assets; ++j) {
-            size_t index = i * number_of_assets + j;
-            result[index] = correlation_matrix(i, j);
-        }
+    if (window_length < 2) {
+        throw std::runtime_error("window_length must be at least 2 for correlation");
     }
 
+    Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+        return_matrix(returns.data(), window_length, number_of_assets);
+
+    RollingCorrelationState state;
+    state.number_of_assets = number_of_assets;
+    state.window_length = window_length;
+    state.gram.resize(static_cast<size_t>(number_of_assets) * number_of_assets);
+    state.column_sums.resize(number_of_assets);
+
+    Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+        gram_matrix(state.gram.data(), number_of_assets, number_of_assets);
+    Eigen::Map<Eigen::VectorXd> column_sums(state.column_sums.data(), number_of_assets);
+
+    gram_matrix = return_matrix.transpose() * return_matrix;
+    column_sums = return_matrix.colwise().sum();
+
+    return state;
+}
+
+void roll_correlation_window(
+    RollingCorrelationState& state,
+    const Vector& outgoing_returns,
+    const Vector& incoming_returns
+) {
+    if (outgoing_returns.size() != state.number_of_assets ||
+        incoming_returns.size() != state.number_of_assets) {
+        throw std::runtime_error("rolling update rows must have size N");
+    }
+
+    Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+        gram_matrix(state.gram.data(), state.number_of_assets, state.number_of_assets);
+    Eigen::Map<Eigen::VectorXd> column_sums(state.column_sums.data(), state.number_of_assets);
+
+    Eigen::Map<const Eigen::VectorXd> outgoing_row(outgoing_returns.data(), state.number_of_assets);
+    Eigen::Map<const Eigen::VectorXd> incoming_row(incoming_returns.data(), state.number_of_assets);
+
+    // Rank-1 downdate for the outgoing row, rank-1 update for the incoming row.
+    gram_matrix.noalias() -= outgoing_row * outgoing_row.transpose();
+    gram_matrix.noalias() += incoming_row * incoming_row.transpose();
+
+    column_sums -= outgoing_row;
+    column_sums += incoming_row;
+}
+
+Matrix correlation_from_rolling_state(const RollingCorrelationState& state) {
+    Matrix result;
+    correlation_from_rolling_state_into(state, result);
     return result;
 }
 
+void correlation_from_rolling_state_into(
+    const RollingCorrelationState& state,
+    Matrix& out_correlation
+) {
+    const uint32_t number_of_assets = state.number_of_assets;
+    const uint32_t window_length = state.window_length;
+
+    if (window_length < 2) {
+        throw std::runtime_error("window_length must be at least 2 for correlation");
+    }
+
+    Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+        gram_matrix(state.gram.data(), number_of_assets, number_of_assets);
+    Eigen::Map<const Eigen::VectorXd> column_sums(state.column_sums.data(), number_of_assets);
+
+    // Cov = (G - s s^T / m) / (m - 1), equivalent to centering then X^T X.
+    Eigen::MatrixXd covariance_matrix =
+        (gram_matrix - (column_sums * column_sums.transpose()) / window_length)
+        / (window_length - 1);
+
+    normalize_covariance_into(covariance_matrix, number_of_assets, out_correlation);
+}
+
 void save_correlation_bin(
     const Matrix& correlation_matrix,
     uint32_t number_of_assets,
@@ -100,3 +288,101 @@ void save_correlation_bin(
 
     output_file.close();
 }
+
+void compute_correlation_masked_into(
+    const Matrix& returns,
+    const ValidityMask& return_valid,
+    uint32_t number_of_assets,
+    uint32_t window_length,
+    uint32_t minimum_observations,
+    Matrix& out_correlation,
+    std::vector<uint32_t>& out_effective_observations
+) {
+    size_t expected_size = static_cast<size_t>(window_length) * number_of_assets;
+    if (returns.size() != expected_size) {
+        throw std::runtime_error("returns size mismatch: expected " +
+                                 std::to_string(expected_size) +
+                                 ", got " + std::to_string(returns.size()));
+    }
+    if (return_valid.size() != expected_size) {
+        throw std::runtime_error("return_valid size mismatch: expected " +
+                                 std::to_string(expected_size) +
+                                 ", got " + std::to_string(return_valid.size()));
+    }
+    if (window_length < 2) {
+        throw std::runtime_error("window_length must be at least 2 for correlation");
+    }
+    if (minimum_observations < 2) {
+        throw std::runtime_error("minimum_observations must be at least 2");
+    }
+
+    Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+        return_matrix(returns.data(), window_length, number_of_assets);
+
+    // Widen the byte mask to an arithmetic 0/1 matrix and force masked
+    // cells of X to exactly 0.0 (the masked return kernel already
+    // guarantees this; re-applying makes the estimator safe for any
+    // caller-provided buffer).
+    Eigen::MatrixXd validity(window_length, number_of_assets);
+    for (uint32_t row = 0; row < window_length; ++row) {
+        const size_t row_offset = static_cast<size_t>(row) * number_of_assets;
+        for (uint32_t col = 0; col < number_of_assets; ++col) {
+            validity(row, col) = return_valid[row_offset + col] != 0 ? 1.0 : 0.0;
+        }
+    }
+    const Eigen::MatrixXd masked_returns =
+        return_matrix.cwiseProduct(validity);
+
+    // Four GEMMs carry the whole pairwise-complete accumulation; every
+    // per-pair statistic below is O(1) arithmetic on their entries.
+    const Eigen::MatrixXd pair_counts = validity.transpose() * validity;
+    const Eigen::MatrixXd masked_sums = masked_returns.transpose() * validity;
+    const Eigen::MatrixXd masked_squared_sums =
+        masked_returns.cwiseProduct(masked_returns).transpose() * validity;
+    const Eigen::MatrixXd cross_products =
+        masked_returns.transpose() * masked_returns;
+
+    out_correlation.resize(static_cast<size_t>(number_of_assets) * number_of_assets);
+    out_effective_observations.resize(
+        static_cast<size_t>(number_of_assets) * number_of_assets);
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int i = 0; i < static_cast<int>(number_of_assets); ++i) {
+        const size_t row_offset = static_cast<size_t>(i) * number_of_assets;
+        for (uint32_t j = 0; j < number_of_assets; ++j) {
+            const double pair_count = pair_counts(i, j);
+            out_effective_observations[row_offset + j] =
+                static_cast<uint32_t>(pair_count);
+
+            if (static_cast<uint32_t>(i) == j) {
+                out_correlation[row_offset + j] = 1.0;
+                continue;
+            }
+            if (pair_count < static_cast<double>(minimum_observations)) {
+                out_correlation[row_offset + j] = 0.0;
+                continue;
+            }
+
+            const double sum_i = masked_sums(i, j);
+            const double sum_j = masked_sums(j, i);
+            const double covariance_sum =
+                cross_products(i, j) - sum_i * sum_j / pair_count;
+            const double variance_sum_i =
+                masked_squared_sums(i, j) - sum_i * sum_i / pair_count;
+            const double variance_sum_j =
+                masked_squared_sums(j, i) - sum_j * sum_j / pair_count;
+
+            if (variance_sum_i <= 1e-20 || variance_sum_j <= 1e-20) {
+                out_correlation[row_offset + j] = 0.0;
+                continue;
+            }
+
+            const double correlation_value =
+                covariance_sum / std::sqrt(variance_sum_i * variance_sum_j);
+            out_correlation[row_offset + j] =
+                std::max(-1.0, std::min(1.0, correlation_value));
+        }
+    }
+}
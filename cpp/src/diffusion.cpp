@@ -1,6 +1,13 @@
 #include "diffusion.hpp"
 
+#ifdef MSI_WITH_CUDA
+#include "gpu.hpp"
+#endif
+
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <fstream>
 #include <stdexcept>
 #include <string>
 
@@ -48,6 +55,171 @@ static void validate_finite_or_throw(double value, const std::string& name) {
     }
 }
 
+/**
+ * @brief Backend selection for the dense expmv in diffuse_returns.
+ *
+ * "auto" (default) picks Lanczos above a size threshold; "eigen" and
+ * "lanczos" force a specific backend via MSI_EXPMV_MODE.
+ */
+enum class ExpmvMode {
+    Auto,
+    Eigen,
+    Lanczos,
+};
+
+static ExpmvMode expmv_mode_from_env() {
+    const char* value = std::getenv("MSI_EXPMV_MODE");
+    if (value == nullptr) {
+        return ExpmvMode::Auto;
+    }
+    const std::string mode(value);
+    if (mode == "eigen") {
+        return ExpmvMode::Eigen;
+    }
+    if (mode == "lanczos") {
+        return ExpmvMode::Lanczos;
+    }
+    return ExpmvMode::Auto;
+}
+
+// Above this dimension the full O(N^3) eigendecomposition loses to a
+// few dozen O(N^2) matvecs; chosen conservatively.
+static constexpr uint32_t kLanczosMinimumDimension = 512;
+
+/**
+ * @brief Compute exp(-eta * L) * r via the Lanczos process.
+ *
+ * Builds an orthonormal Krylov basis V_k with full reorthogonalization
+ * and evaluates the exponential on the small tridiagonal projection:
+ *   s ~= ||r|| * V_k * exp(-eta * T_k) * e_1
+ * The iteration stops when the difference between successive Krylov
+ * approximations (measured in coefficient space, where V_k is
+ * orthonormal) falls below tolerance, after a minimum iteration floor.
+ * The textbook residual estimate beta_k * |e_k^T exp(-eta T_k) e_1| is
+ * deliberately not used: for stiff spectra (eta times the Laplacian
+ * norm large) every entry of exp(-eta T_k) e_1 is astronomically small
+ * from the very first iteration, so that estimate reports convergence
+ * while the slow eigenmodes that dominate exp(-eta L) r are still
+ * unresolved. The successive-difference test also stalls near zero for
+ * the first few iterations on such spectra, which is what the floor
+ * rides out.
+ */
+static Eigen::VectorXd lanczos_expmv(
+    const Eigen::Ref<const Eigen::MatrixXd>& laplacian_matrix,
+    const Eigen::VectorXd& return_vector,
+    double diffusion_eta
+) {
+    const Eigen::Index dimension = return_vector.size();
+    const double return_norm = return_vector.norm();
+    if (return_norm == 0.0) {
+        return Eigen::VectorXd::Zero(dimension);
+    }
+
+    const int max_krylov_dimension =
+        static_cast<int>(std::min<Eigen::Index>(dimension, 96));
+    // Never trust a converged-looking step before the floor: the first
+    // few iterations can sit at an exact-looking plateau before the
+    // smallest Ritz value separates from a stiff cluster.
+    const int minimum_krylov_dimension =
+        static_cast<int>(std::min<Eigen::Index>(dimension, 10));
+    const double relative_tolerance = 1e-12;
+    const double breakdown_tolerance = 1e-14 * return_norm;
+
+    Eigen::MatrixXd krylov_basis(dimension, max_krylov_dimension);
+    Eigen::VectorXd diagonal(max_krylov_dimension);
+    Eigen::VectorXd off_diagonal(max_krylov_dimension);
+
+    krylov_basis.col(0) = return_vector / return_norm;
+
+    Eigen::VectorXd candidate(dimension);
+    Eigen::VectorXd small_solution;
+    Eigen::VectorXd previous_small_solution;
+    int krylov_dimension = 0;
+    bool converged = false;
+
+    for (int j = 0; j < max_krylov_dimension; ++j) {
+        candidate.noalias() = laplacian_matrix.selfadjointView<Eigen::Lower>() * krylov_basis.col(j);
+
+        diagonal(j) = krylov_basis.col(j).dot(candidate);
+        candidate -= diagonal(j) * krylov_basis.col(j);
+        if (j > 0) {
+            candidate -= off_diagonal(j - 1) * krylov_basis.col(j - 1);
+        }
+
+        // Full reorthogonalization keeps the basis numerically orthonormal.
+        candidate.noalias() -=
+            krylov_basis.leftCols(j + 1) *
+            (krylov_basis.leftCols(j + 1).transpose() * candidate);
+
+        off_diagonal(j) = candidate.norm();
+        krylov_dimension = j + 1;
+
+        // Evaluate exp(-eta * T_k) e_1 on the tridiagonal projection.
+        Eigen::MatrixXd tridiagonal = Eigen::MatrixXd::Zero(krylov_dimension, krylov_dimension);
+        for (int i = 0; i < krylov_dimension; ++i) {
+            tridiagonal(i, i) = diagonal(i);
+            if (i + 1 < krylov_dimension) {
+                tridiagonal(i + 1, i) = off_diagonal(i);
+                tridiagonal(i, i + 1) = off_diagonal(i);
+            }
+        }
+
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> small_solver(tridiagonal);
+        if (small_solver.info() != Eigen::Success) {
+            throw std::runtime_error("Lanczos tridiagonal eigensolve failed");
+        }
+
+        const Eigen::VectorXd exponent_scales =
+            (-diffusion_eta * small_solver.eigenvalues().array()).exp().matrix();
+        small_solution =
+            small_solver.eigenvectors() *
+            (exponent_scales.array() *
+             small_solver.eigenvectors().row(0).transpose().array()).matrix();
+
+        if (off_diagonal(j) <= breakdown_tolerance) {
+            // Invariant subspace found: the projection is exact.
+            converged = true;
+            break;
+        }
+
+        if (krylov_dimension == static_cast<int>(dimension)) {
+            // The basis spans the whole space; the projection is exact.
+            converged = true;
+            break;
+        }
+
+        // Successive-difference convergence: ||s_k - s_{k-1}|| equals
+        // the coefficient-space difference because V_k is orthonormal.
+        if (j > 0 && krylov_dimension >= minimum_krylov_dimension) {
+            double step_norm_squared = 0.0;
+            for (int i = 0; i < krylov_dimension - 1; ++i) {
+                const double delta = small_solution(i) - previous_small_solution(i);
+                step_norm_squared += delta * delta;
+            }
+            step_norm_squared +=
+                small_solution(krylov_dimension - 1) * small_solution(krylov_dimension - 1);
+            if (std::sqrt(step_norm_squared) <= relative_tolerance) {
+                converged = true;
+                break;
+            }
+        }
+        previous_small_solution = small_solution;
+
+        if (j + 1 < max_krylov_dimension) {
+            krylov_basis.col(j + 1) = candidate / off_diagonal(j);
+        }
+    }
+
+    if (!converged) {
+        throw std::runtime_error(
+            "Lanczos expmv failed to converge within " +
+            std::to_string(max_krylov_dimension) + " iterations"
+        );
+    }
+
+    return return_norm * (krylov_basis.leftCols(krylov_dimension) * small_solution);
+}
+
 Vector diffuse_returns(
     const Matrix& laplacian,
     const Vector& latest_return,
@@ -58,26 +230,40 @@ Vector diffuse_returns(
     validate_vector_size_or_throw(latest_return, number_of_assets, "latest_return");
     validate_finite_or_throw(diffusion_eta, "diffusion_eta");
 
-    // Convert laplacian (row-major std::vector) -> Eigen matrix
-    Eigen::MatrixXd laplacian_matrix =
-        Eigen::MatrixXd::Zero(static_cast<int>(number_of_assets), static_cast<int>(number_of_assets));
+    // Map laplacian (row-major std::vector) and returns into Eigen views;
+    // the Laplacian is symmetric so the row-major layout is safe to read
+    // as column-major.
+    Eigen::Map<const Eigen::MatrixXd> laplacian_matrix(
+        laplacian.data(), number_of_assets, number_of_assets);
+    Eigen::Map<const Eigen::VectorXd> return_vector(
+        latest_return.data(), number_of_assets);
 
-    for (uint32_t row_index = 0; row_index < number_of_assets; ++row_index) {
-        for (uint32_t column_index = 0; column_index < number_of_assets; ++column_index) {
-            const size_t flat_index =
-                static_cast<size_t>(row_index) * static_cast<size_t>(number_of_assets) +
-                static_cast<size_t>(column_index);
+    const ExpmvMode mode = expmv_mode_from_env();
+    const bool use_lanczos =
+        mode == ExpmvMode::Lanczos ||
+        (mode == ExpmvMode::Auto && number_of_assets >= kLanczosMinimumDimension);
 
-            laplacian_matrix(static_cast<int>(row_index), static_cast<int>(column_index)) =
-                laplacian[flat_index];
+    if (use_lanczos) {
+        const Eigen::VectorXd smoothed_vector =
+            lanczos_expmv(laplacian_matrix, return_vector, diffusion_eta);
+
+        Vector smoothed_return(static_cast<size_t>(number_of_assets), 0.0);
+        for (uint32_t asset_index = 0; asset_index < number_of_assets; ++asset_index) {
+            const double smoothed_value = smoothed_vector(static_cast<int>(asset_index));
+            validate_finite_or_throw(smoothed_value, "smoothed_return entry");
+            smoothed_return[static_cast<size_t>(asset_index)] = smoothed_value;
         }
+        return smoothed_return;
     }
 
-    // Convert returns -> Eigen vector
-    Eigen::VectorXd return_vector = Eigen::VectorXd::Zero(static_cast<int>(number_of_assets));
-    for (uint32_t asset_index = 0; asset_index < number_of_assets; ++asset_index) {
-        return_vector(static_cast<int>(asset_index)) = latest_return[static_cast<size_t>(asset_index)];
+#ifdef MSI_WITH_CUDA
+    if (gpu_backend_available()) {
+        const SpectralDecomposition decomposition =
+            gpu_compute_spectral_decomposition(laplacian, number_of_assets);
+        return diffuse_returns_with_decomposition(
+            decomposition, latest_return, number_of_assets, diffusion_eta);
     }
+#endif
 
     // Laplacian should be symmetric; use self-adjoint eigendecomposition.
     Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigen_solver(laplacian_matrix);
@@ -115,6 +301,298 @@ Vector diffuse_returns(
     return smoothed_return;
 }
 
+static void sparse_matvec(
+    const SparseMatrixCSR& matrix,
+    const Vector& input,
+    Vector& output
+) {
+    const size_t number_of_rows = matrix.row_offsets.size() - 1;
+    for (size_t i = 0; i < number_of_rows; ++i) {
+        double sum = 0.0;
+        for (size_t k = matrix.row_offsets[i]; k < matrix.row_offsets[i + 1]; ++k) {
+            sum += matrix.values[k] * input[matrix.column_indices[k]];
+        }
+        output[i] = sum;
+    }
+}
+
+Vector diffuse_returns_sparse(
+    const SparseMatrixCSR& laplacian,
+    const Vector& latest_return,
+    uint32_t number_of_assets,
+    double diffusion_eta
+) {
+    if (laplacian.row_offsets.size() != static_cast<size_t>(number_of_assets) + 1) {
+        throw std::runtime_error("laplacian row_offsets must have size N + 1");
+    }
+    validate_vector_size_or_throw(latest_return, number_of_assets, "latest_return");
+    validate_finite_or_throw(diffusion_eta, "diffusion_eta");
+    if (diffusion_eta < 0.0) {
+        throw std::runtime_error("diffusion_eta must be >= 0");
+    }
+
+    if (diffusion_eta == 0.0 || laplacian.values.empty()) {
+        return latest_return;
+    }
+
+    // Gershgorin bound: every Laplacian eigenvalue lies in
+    // [0, 2 * max_degree], where the degree sits on the diagonal.
+    double max_diagonal = 0.0;
+    for (uint32_t i = 0; i < number_of_assets; ++i) {
+        for (size_t k = laplacian.row_offsets[i]; k < laplacian.row_offsets[static_cast<size_t>(i) + 1]; ++k) {
+            if (laplacian.column_indices[k] == i) {
+                max_diagonal = std::max(max_diagonal, laplacian.values[k]);
+            }
+        }
+    }
+    const double spectral_bound = 2.0 * max_diagonal;
+
+    // Split exp(-eta * L) into sub-steps small enough that the Taylor
+    // series of each sub-step converges in a handful of terms.
+    const double series_norm_target = 1.0;
+    const int number_of_steps = std::max(
+        1,
+        static_cast<int>(std::ceil(diffusion_eta * spectral_bound / series_norm_target))
+    );
+    const double step_eta = diffusion_eta / number_of_steps;
+
+    const int max_series_terms = 64;
+    const double relative_tolerance = 1e-14;
+
+    Vector current = latest_return;
+    Vector term = latest_return;
+    Vector matvec_result(number_of_assets, 0.0);
+    Vector accumulator(number_of_assets, 0.0);
+
+    for (int step = 0; step < number_of_steps; ++step) {
+        // accumulator = sum_k (-step_eta * L)^k / k! * current
+        accumulator = current;
+        term = current;
+
+        for (int series_term = 1; series_term <= max_series_terms; ++series_term) {
+            sparse_matvec(laplacian, term, matvec_result);
+
+            double term_sum_squares = 0.0;
+            double accumulator_sum_squares = 0.0;
+            for (uint32_t i = 0; i < number_of_assets; ++i) {
+                const double next_value =
+                    matvec_result[i] * (-step_eta / static_cast<double>(series_term));
+                term[i] = next_value;
+                accumulator[i] += next_value;
+                term_sum_squares += next_value * next_value;
+                accumulator_sum_squares += accumulator[i] * accumulator[i];
+            }
+
+            if (term_sum_squares <=
+                relative_tolerance * relative_tolerance * accumulator_sum_squares) {
+                break;
+            }
+        }
+
+        current = accumulator;
+    }
+
+    for (uint32_t i = 0; i < number_of_assets; ++i) {
+        validate_finite_or_throw(current[i], "smoothed_return entry");
+    }
+
+    return current;
+}
+
+SpectralDecomposition compute_spectral_decomposition(
+    const Matrix& laplacian,
+    uint32_t number_of_assets
+) {
+    validate_square_matrix_size_or_throw(laplacian, number_of_assets, "laplacian");
+
+#ifdef MSI_WITH_CUDA
+    if (gpu_backend_available()) {
+        return gpu_compute_spectral_decomposition(laplacian, number_of_assets);
+    }
+#endif
+
+    Eigen::Map<const Eigen::MatrixXd> laplacian_matrix(
+        laplacian.data(), number_of_assets, number_of_assets);
+
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigen_solver(laplacian_matrix);
+    if (eigen_solver.info() != Eigen::Success) {
+        throw std::runtime_error("SelfAdjointEigenSolver failed for Laplacian matrix");
+    }
+
+    SpectralDecomposition decomposition;
+    decomposition.eigenvalues.resize(number_of_assets);
+    decomposition.eigenvectors.resize(
+        static_cast<size_t>(number_of_assets) * number_of_assets);
+
+    Eigen::Map<Eigen::VectorXd>(decomposition.eigenvalues.data(), number_of_assets) =
+        eigen_solver.eigenvalues();
+    Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>(
+        decomposition.eigenvectors.data(), number_of_assets, number_of_assets) =
+        eigen_solver.eigenvectors();
+
+    return decomposition;
+}
+
+Vector diffuse_returns_with_decomposition(
+    const SpectralDecomposition& decomposition,
+    const Vector& latest_return,
+    uint32_t number_of_assets,
+    double diffusion_eta
+) {
+    validate_vector_size_or_throw(latest_return, number_of_assets, "latest_return");
+    validate_finite_or_throw(diffusion_eta, "diffusion_eta");
+    if (decomposition.eigenvalues.size() != number_of_assets ||
+        decomposition.eigenvectors.size() !=
+            static_cast<size_t>(number_of_assets) * number_of_assets) {
+        throw std::runtime_error("decomposition dimensions do not match N");
+    }
+
+    Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+        eigenvectors(decomposition.eigenvectors.data(), number_of_assets, number_of_assets);
+    Eigen::Map<const Eigen::VectorXd> eigenvalues(
+        decomposition.eigenvalues.data(), number_of_assets);
+    Eigen::Map<const Eigen::VectorXd> return_vector(
+        latest_return.data(), number_of_assets);
+
+    const Eigen::VectorXd projected_returns = eigenvectors.transpose() * return_vector;
+    const Eigen::VectorXd scaled_projected_returns =
+        ((-diffusion_eta * eigenvalues.array()).exp() * projected_returns.array()).matrix();
+    const Eigen::VectorXd smoothed_vector = eigenvectors * scaled_projected_returns;
+
+    Vector smoothed_return(static_cast<size_t>(number_of_assets), 0.0);
+    for (uint32_t asset_index = 0; asset_index < number_of_assets; ++asset_index) {
+        const double smoothed_value = smoothed_vector(static_cast<int>(asset_index));
+        validate_finite_or_throw(smoothed_value, "smoothed_return entry");
+        smoothed_return[static_cast<size_t>(asset_index)] = smoothed_value;
+    }
+
+    return smoothed_return;
+}
+
+std::vector<Vector> diffuse_returns_multi_eta(
+    const Matrix& laplacian,
+    const Vector& latest_return,
+    uint32_t number_of_assets,
+    const std::vector<double>& diffusion_etas
+) {
+    validate_vector_size_or_throw(latest_return, number_of_assets, "latest_return");
+    if (diffusion_etas.empty()) {
+        throw std::runtime_error("diffusion_etas must contain at least one eta");
+    }
+    for (double diffusion_eta : diffusion_etas) {
+        validate_finite_or_throw(diffusion_eta, "diffusion_eta");
+    }
+
+    // Factorize once; every eta reuses the same eigenpairs.
+    const SpectralDecomposition decomposition =
+        compute_spectral_decomposition(laplacian, number_of_assets);
+
+    Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+        eigenvectors(decomposition.eigenvectors.data(), number_of_assets, number_of_assets);
+    Eigen::Map<const Eigen::VectorXd> eigenvalues(
+        decomposition.eigenvalues.data(), number_of_assets);
+    Eigen::Map<const Eigen::VectorXd> return_vector(
+        latest_return.data(), number_of_assets);
+
+    // Project r once; per eta only the spectral filter and the
+    // back-transform remain.
+    const Eigen::VectorXd projected_returns = eigenvectors.transpose() * return_vector;
+
+    std::vector<Vector> smoothed_returns;
+    smoothed_returns.reserve(diffusion_etas.size());
+
+    for (double diffusion_eta : diffusion_etas) {
+        const Eigen::VectorXd scaled_projected_returns =
+            ((-diffusion_eta * eigenvalues.array()).exp() * projected_returns.array()).matrix();
+        const Eigen::VectorXd smoothed_vector = eigenvectors * scaled_projected_returns;
+
+        Vector smoothed_return(static_cast<size_t>(number_of_assets), 0.0);
+        for (uint32_t asset_index = 0; asset_index < number_of_assets; ++asset_index) {
+            const double smoothed_value = smoothed_vector(static_cast<int>(asset_index));
+            validate_finite_or_throw(smoothed_value, "smoothed_return entry");
+            smoothed_return[static_cast<size_t>(asset_index)] = smoothed_value;
+        }
+        smoothed_returns.push_back(std::move(smoothed_return));
+    }
+
+    return smoothed_returns;
+}
+
+void save_spectral_cache_bin(
+    const SpectralDecomposition& decomposition,
+    uint32_t number_of_assets,
+    uint64_t key_hash,
+    const std::string& output_path
+) {
+    if (decomposition.eigenvalues.size() != number_of_assets ||
+        decomposition.eigenvectors.size() !=
+            static_cast<size_t>(number_of_assets) * number_of_assets) {
+        throw std::runtime_error("decomposition dimensions do not match N");
+    }
+
+    std::ofstream output_file(output_path, std::ios::binary);
+    if (!output_file.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + output_path);
+    }
+
+    output_file.write(reinterpret_cast<const char*>(&number_of_assets), sizeof(uint32_t));
+    output_file.write(reinterpret_cast<const char*>(&key_hash), sizeof(uint64_t));
+    output_file.write(
+        reinterpret_cast<const char*>(decomposition.eigenvalues.data()),
+        decomposition.eigenvalues.size() * sizeof(double)
+    );
+    output_file.write(
+        reinterpret_cast<const char*>(decomposition.eigenvectors.data()),
+        decomposition.eigenvectors.size() * sizeof(double)
+    );
+
+    if (!output_file.good()) {
+        throw std::runtime_error("Error writing to file: " + output_path);
+    }
+
+    output_file.close();
+}
+
+SpectralDecomposition load_spectral_cache_bin(
+    const std::string& input_path,
+    uint32_t& out_number_of_assets,
+    uint64_t& out_key_hash
+) {
+    std::ifstream input_file(input_path, std::ios::binary);
+    if (!input_file.is_open()) {
+        throw std::runtime_error("Failed to open file for reading: " + input_path);
+    }
+
+    uint32_t number_of_assets = 0;
+    uint64_t key_hash = 0;
+    input_file.read(reinterpret_cast<char*>(&number_of_assets), sizeof(uint32_t));
+    input_file.read(reinterpret_cast<char*>(&key_hash), sizeof(uint64_t));
+    if (!input_file.good()) {
+        throw std::runtime_error("Failed to read spectral cache header from: " + input_path);
+    }
+
+    SpectralDecomposition decomposition;
+    decomposition.eigenvalues.resize(number_of_assets);
+    decomposition.eigenvectors.resize(
+        static_cast<size_t>(number_of_assets) * number_of_assets);
+
+    input_file.read(
+        reinterpret_cast<char*>(decomposition.eigenvalues.data()),
+        decomposition.eigenvalues.size() * sizeof(double)
+    );
+    input_file.read(
+        reinterpret_cast<char*>(decomposition.eigenvectors.data()),
+        decomposition.eigenvectors.size() * sizeof(double)
+    );
+    if (!input_file.good()) {
+        throw std::runtime_error("Failed to read spectral cache data from: " + input_path);
+    }
+
+    out_number_of_assets = number_of_assets;
+    out_key_hash = key_hash;
+    return decomposition;
+}
+
 double compute_systemic_ratio(
     const Vector& smoothed_return,
     const Vector& latest_return
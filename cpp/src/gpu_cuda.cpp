@@ -0,0 +1,359 @@
+// CUDA backend for the dense linear algebra stages. Only compiled when
+// the tree is configured with -DMSI_WITH_CUDA=ON (see cpp/CMakeLists.txt);
+// the default build never references these symbols.
+
+#include "gpu.hpp"
+
+#include <cuda_runtime.h>
+#include <cublas_v2.h>
+#include <cusolverDn.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// ---------------------------------------------------------------------------
+// Error handling: every CUDA / cuBLAS / cuSOLVER status is checked and
+// surfaced as std::runtime_error, matching the rest of the library.
+// ---------------------------------------------------------------------------
+
+static void cuda_check(cudaError_t status, const std::string& what) {
+    if (status != cudaSuccess) {
+        throw std::runtime_error(
+            what + " failed: " + cudaGetErrorString(status));
+    }
+}
+
+static void cublas_check(cublasStatus_t status, const std::string& what) {
+    if (status != CUBLAS_STATUS_SUCCESS) {
+        throw std::runtime_error(
+            what + " failed: cuBLAS status " + std::to_string(status));
+    }
+}
+
+static void cusolver_check(cusolverStatus_t status, const std::string& what) {
+    if (status != CUSOLVER_STATUS_SUCCESS) {
+        throw std::runtime_error(
+            what + " failed: cuSOLVER status " + std::to_string(status));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Context: one handle pair plus grow-only device and pinned staging
+// buffers, created on first use and kept for the life of the process so
+// batch backfills pay the allocation cost once. Not thread-safe beyond
+// the C++11 static-init guarantee; the pipeline runs these stages from
+// a single thread.
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct GpuContext {
+    cublasHandle_t cublas_handle = nullptr;
+    cusolverDnHandle_t cusolver_handle = nullptr;
+    cudaStream_t stream = nullptr;
+
+    // Grow-only device scratch: the input operand (centered window or
+    // Laplacian) and the N x N result share these two slots across calls.
+    double* device_input = nullptr;
+    size_t device_input_capacity = 0;
+    double* device_output = nullptr;
+    size_t device_output_capacity = 0;
+
+    // Pinned host staging for H2D/D2H transfers; pageable std::vector /
+    // Eigen buffers are copied through here so cudaMemcpyAsync can
+    // actually overlap and run at full PCIe bandwidth.
+    double* pinned_staging = nullptr;
+    size_t pinned_staging_capacity = 0;
+
+    // cuSOLVER workspace, sized by the query on first use and regrown
+    // only when N grows.
+    double* device_workspace = nullptr;
+    size_t device_workspace_capacity = 0;
+    int* device_solver_info = nullptr;
+
+    bool initialized = false;
+
+    ~GpuContext() {
+        // Best-effort teardown at process exit; errors are ignored
+        // because the driver may already be shutting down.
+        if (device_input != nullptr) cudaFree(device_input);
+        if (device_output != nullptr) cudaFree(device_output);
+        if (device_workspace != nullptr) cudaFree(device_workspace);
+        if (device_solver_info != nullptr) cudaFree(device_solver_info);
+        if (pinned_staging != nullptr) cudaFreeHost(pinned_staging);
+        if (cusolver_handle != nullptr) cusolverDnDestroy(cusolver_handle);
+        if (cublas_handle != nullptr) cublasDestroy(cublas_handle);
+        if (stream != nullptr) cudaStreamDestroy(stream);
+    }
+};
+
+GpuContext& gpu_context() {
+    static GpuContext context;
+    return context;
+}
+
+bool initialize_gpu_context() {
+    const char* value = std::getenv("MSI_GPU");
+    if (value != nullptr && std::string(value) == "0") {
+        return false;
+    }
+
+    int device_count = 0;
+    if (cudaGetDeviceCount(&device_count) != cudaSuccess || device_count == 0) {
+        return false;
+    }
+
+    GpuContext& context = gpu_context();
+    try {
+        cuda_check(cudaStreamCreate(&context.stream), "cudaStreamCreate");
+        cublas_check(cublasCreate(&context.cublas_handle), "cublasCreate");
+        cublas_check(
+            cublasSetStream(context.cublas_handle, context.stream),
+            "cublasSetStream");
+        cusolver_check(
+            cusolverDnCreate(&context.cusolver_handle), "cusolverDnCreate");
+        cusolver_check(
+            cusolverDnSetStream(context.cusolver_handle, context.stream),
+            "cusolverDnSetStream");
+        cuda_check(
+            cudaMalloc(&context.device_solver_info, sizeof(int)),
+            "cudaMalloc solver info");
+    } catch (const std::exception& error) {
+        std::cerr << "GPU backend disabled: " << error.what() << std::endl;
+        return false;
+    }
+
+    context.initialized = true;
+    return true;
+}
+
+// Grow a device buffer to at least element_count doubles.
+void ensure_device_capacity(
+    double*& device_buffer,
+    size_t& capacity,
+    size_t element_count
+) {
+    if (capacity >= element_count) {
+        return;
+    }
+    if (device_buffer != nullptr) {
+        cuda_check(cudaFree(device_buffer), "cudaFree");
+        device_buffer = nullptr;
+        capacity = 0;
+    }
+    cuda_check(
+        cudaMalloc(&device_buffer, element_count * sizeof(double)),
+        "cudaMalloc");
+    capacity = element_count;
+}
+
+// Grow the pinned host staging buffer to at least element_count doubles.
+void ensure_pinned_capacity(GpuContext& context, size_t element_count) {
+    if (context.pinned_staging_capacity >= element_count) {
+        return;
+    }
+    if (context.pinned_staging != nullptr) {
+        cuda_check(cudaFreeHost(context.pinned_staging), "cudaFreeHost");
+        context.pinned_staging = nullptr;
+        context.pinned_staging_capacity = 0;
+    }
+    cuda_check(
+        cudaMallocHost(&context.pinned_staging, element_count * sizeof(double)),
+        "cudaMallocHost");
+    context.pinned_staging_capacity = element_count;
+}
+
+// Copy a pageable host buffer to the device through the pinned staging
+// buffer, then synchronize so the staging buffer can be reused.
+void upload_through_staging(
+    GpuContext& context,
+    const double* host_source,
+    double* device_destination,
+    size_t element_count
+) {
+    ensure_pinned_capacity(context, element_count);
+    std::memcpy(
+        context.pinned_staging, host_source, element_count * sizeof(double));
+    cuda_check(
+        cudaMemcpyAsync(
+            device_destination, context.pinned_staging,
+            element_count * sizeof(double), cudaMemcpyHostToDevice,
+            context.stream),
+        "cudaMemcpyAsync H2D");
+    cuda_check(cudaStreamSynchronize(context.stream), "cudaStreamSynchronize");
+}
+
+// Copy a device buffer back to pageable host memory through staging.
+void download_through_staging(
+    GpuContext& context,
+    const double* device_source,
+    double* host_destination,
+    size_t element_count
+) {
+    ensure_pinned_capacity(context, element_count);
+    cuda_check(
+        cudaMemcpyAsync(
+            context.pinned_staging, device_source,
+            element_count * sizeof(double), cudaMemcpyDeviceToHost,
+            context.stream),
+        "cudaMemcpyAsync D2H");
+    cuda_check(cudaStreamSynchronize(context.stream), "cudaStreamSynchronize");
+    std::memcpy(
+        host_destination, context.pinned_staging,
+        element_count * sizeof(double));
+}
+
+} // namespace
+
+bool gpu_backend_available() {
+    static const bool available = initialize_gpu_context();
+    return available;
+}
+
+void gpu_compute_covariance(
+    const double* centered_returns,
+    uint32_t window_length,
+    uint32_t number_of_assets,
+    double scale,
+    double* out_covariance
+) {
+    if (!gpu_backend_available()) {
+        throw std::runtime_error("gpu_compute_covariance called without GPU backend");
+    }
+
+    GpuContext& context = gpu_context();
+    const size_t input_count =
+        static_cast<size_t>(window_length) * number_of_assets;
+    const size_t output_count =
+        static_cast<size_t>(number_of_assets) * number_of_assets;
+
+    ensure_device_capacity(
+        context.device_input, context.device_input_capacity, input_count);
+    ensure_device_capacity(
+        context.device_output, context.device_output_capacity, output_count);
+
+    upload_through_staging(
+        context, centered_returns, context.device_input, input_count);
+
+    // X is column-major [m x N] with leading dimension m; OP_T gives
+    // C = scale * X^T * X on the lower triangle, the cuBLAS analogue of
+    // the Eigen rankUpdate in the CPU path.
+    const double beta = 0.0;
+    cublas_check(
+        cublasDsyrk(
+            context.cublas_handle, CUBLAS_FILL_MODE_LOWER, CUBLAS_OP_T,
+            static_cast<int>(number_of_assets),
+            static_cast<int>(window_length),
+            &scale, context.device_input, static_cast<int>(window_length),
+            &beta, context.device_output, static_cast<int>(number_of_assets)),
+        "cublasDsyrk");
+
+    download_through_staging(
+        context, context.device_output, out_covariance, output_count);
+
+    // Mirror the column-major lower triangle into the upper so callers
+    // see a fully populated symmetric matrix, as on the CPU path.
+    for (uint32_t j = 1; j < number_of_assets; ++j) {
+        for (uint32_t i = 0; i < j; ++i) {
+            out_covariance[static_cast<size_t>(i) +
+                           static_cast<size_t>(j) * number_of_assets] =
+                out_covariance[static_cast<size_t>(j) +
+                               static_cast<size_t>(i) * number_of_assets];
+        }
+    }
+}
+
+SpectralDecomposition gpu_compute_spectral_decomposition(
+    const Matrix& laplacian,
+    uint32_t number_of_assets
+) {
+    if (!gpu_backend_available()) {
+        throw std::runtime_error(
+            "gpu_compute_spectral_decomposition called without GPU backend");
+    }
+
+    const size_t matrix_count =
+        static_cast<size_t>(number_of_assets) * number_of_assets;
+    if (laplacian.size() != matrix_count) {
+        throw std::runtime_error("laplacian size mismatch: expected " +
+                                 std::to_string(matrix_count) +
+                                 ", got " + std::to_string(laplacian.size()));
+    }
+
+    GpuContext& context = gpu_context();
+
+    // The Laplacian is symmetric, so the row-major host buffer can be
+    // uploaded as-is and read as column-major by cuSOLVER.
+    ensure_device_capacity(
+        context.device_input, context.device_input_capacity, matrix_count);
+    ensure_device_capacity(
+        context.device_output, context.device_output_capacity, number_of_assets);
+    upload_through_staging(
+        context, laplacian.data(), context.device_input, matrix_count);
+
+    int workspace_count = 0;
+    cusolver_check(
+        cusolverDnDsyevd_bufferSize(
+            context.cusolver_handle, CUSOLVER_EIG_MODE_VECTOR,
+            CUBLAS_FILL_MODE_LOWER, static_cast<int>(number_of_assets),
+            context.device_input, static_cast<int>(number_of_assets),
+            context.device_output, &workspace_count),
+        "cusolverDnDsyevd_bufferSize");
+    ensure_device_capacity(
+        context.device_workspace, context.device_workspace_capacity,
+        static_cast<size_t>(workspace_count));
+
+    cusolver_check(
+        cusolverDnDsyevd(
+            context.cusolver_handle, CUSOLVER_EIG_MODE_VECTOR,
+            CUBLAS_FILL_MODE_LOWER, static_cast<int>(number_of_assets),
+            context.device_input, static_cast<int>(number_of_assets),
+            context.device_output, context.device_workspace, workspace_count,
+            context.device_solver_info),
+        "cusolverDnDsyevd");
+
+    int solver_info = 0;
+    cuda_check(
+        cudaMemcpy(
+            &solver_info, context.device_solver_info, sizeof(int),
+            cudaMemcpyDeviceToHost),
+        "cudaMemcpy solver info");
+    if (solver_info != 0) {
+        throw std::runtime_error(
+            "cusolverDnDsyevd failed for Laplacian matrix: info = " +
+            std::to_string(solver_info));
+    }
+
+    SpectralDecomposition decomposition;
+    decomposition.eigenvalues.resize(number_of_assets);
+    decomposition.eigenvectors.resize(matrix_count);
+
+    download_through_staging(
+        context, context.device_output, decomposition.eigenvalues.data(),
+        number_of_assets);
+
+    // cuSOLVER leaves the eigenvectors column-major in the input slot
+    // (eigenvector k in column k). Stage them back and transpose into
+    // the row-major layout compute_spectral_decomposition's CPU path
+    // produces, so downstream consumers are backend-agnostic.
+    ensure_pinned_capacity(context, matrix_count);
+    cuda_check(
+        cudaMemcpyAsync(
+            context.pinned_staging, context.device_input,
+            matrix_count * sizeof(double), cudaMemcpyDeviceToHost,
+            context.stream),
+        "cudaMemcpyAsync D2H");
+    cuda_check(cudaStreamSynchronize(context.stream), "cudaStreamSynchronize");
+    for (uint32_t i = 0; i < number_of_assets; ++i) {
+        for (uint32_t k = 0; k < number_of_assets; ++k) {
+            decomposition.eigenvectors[static_cast<size_t>(i) * number_of_assets + k] =
+                context.pinned_staging[static_cast<size_t>(i) +
+                                       static_cast<size_t>(k) * number_of_assets];
+        }
+    }
+
+    return decomposition;
+}
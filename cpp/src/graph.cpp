@@ -1,11 +1,17 @@
 #include "graph.hpp"
 
 #include <algorithm>
+#include <cstdlib>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include <Eigen/Dense>
+
+template <typename Scalar>
 static void validate_square_matrix_or_throw(
-    const Matrix& matrix,
+    const MatrixT<Scalar>& matrix,
     uint32_t number_of_assets,
     const std::string& name
 ) {
@@ -17,8 +23,9 @@ static void validate_square_matrix_or_throw(
     }
 }
 
+template <typename Scalar>
 static void validate_vector_or_throw(
-    const Vector& vector,
+    const VectorT<Scalar>& vector,
     uint32_t number_of_assets,
     const std::string& name
 ) {
@@ -27,9 +34,97 @@ static void validate_vector_or_throw(
     }
 }
 
+/**
+ * @brief True if the scalar reference kernels were requested.
+ *
+ * The vectorized Eigen kernels are the default; set MSI_SCALAR_KERNELS=1
+ * to fall back to the original element-by-element loops.
+ */
+static bool use_scalar_kernel_path() {
+    const char* value = std::getenv("MSI_SCALAR_KERNELS");
+    return value != nullptr && value[0] == '1';
+}
+
+template <typename Scalar>
+using RowMajorMatrix =
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+using RowMajorMatrixXd = RowMajorMatrix<double>;
+
+/**
+ * @brief Single vectorized NaN/Inf scan over a whole matrix.
+ *
+ * Hoists finiteness validation out of the per-element kernels so the
+ * O(N^2) loops below stay branch-free.
+ */
+template <typename Scalar>
+static void validate_all_finite_or_throw(
+    const MatrixT<Scalar>& matrix,
+    const std::string& name
+) {
+    Eigen::Map<const Eigen::Array<Scalar, Eigen::Dynamic, 1>> values(
+        matrix.data(), static_cast<Eigen::Index>(matrix.size()));
+    if (!values.isFinite().all()) {
+        throw std::runtime_error(name + " must be finite (not NaN/Inf)");
+    }
+}
+
+/**
+ * @brief Vectorized adjacency kernel, generic over the scalar type.
+ *
+ * Shared by the double path and the float32 compute mode.
+ */
+template <typename Scalar>
+static void build_weighted_graph_vectorized_into(
+    const MatrixT<Scalar>& correlation_matrix,
+    uint32_t number_of_assets,
+    MatrixT<Scalar>& out_weighted_adjacency
+) {
+    validate_all_finite_or_throw(correlation_matrix, "correlation_matrix");
+
+    Eigen::Map<const RowMajorMatrix<Scalar>> correlation(
+        correlation_matrix.data(), number_of_assets, number_of_assets);
+    Eigen::Map<RowMajorMatrix<Scalar>> adjacency(
+        out_weighted_adjacency.data(), number_of_assets, number_of_assets);
+
+    adjacency = correlation.array().max(Scalar(0)).matrix();
+    adjacency.diagonal().setZero();
+}
+
+/**
+ * @brief Vectorized in-place Laplacian kernel, generic over the scalar
+ *        type. Shared by the double path and the float32 compute mode.
+ */
+template <typename Scalar>
+static void compute_laplacian_in_place_vectorized(
+    MatrixT<Scalar>& weighted_adjacency,
+    uint32_t number_of_assets
+) {
+    validate_all_finite_or_throw(weighted_adjacency, "weighted_adjacency");
+
+    Eigen::Map<RowMajorMatrix<Scalar>> matrix(
+        weighted_adjacency.data(), number_of_assets, number_of_assets);
+
+    // Degrees are captured before the negation overwrites W with -W;
+    // the adjacency diagonal is zero so the overwrite is exact.
+    Eigen::Matrix<Scalar, Eigen::Dynamic, 1> degrees = matrix.rowwise().sum();
+    matrix = -matrix;
+    matrix.diagonal() = degrees;
+}
+
 Matrix build_weighted_graph(
     const Matrix& correlation_matrix,
     uint32_t number_of_assets
+) {
+    Matrix weighted_adjacency;
+    build_weighted_graph_into(correlation_matrix, number_of_assets, weighted_adjacency);
+    return weighted_adjacency;
+}
+
+void build_weighted_graph_into(
+    const Matrix& correlation_matrix,
+    uint32_t number_of_assets,
+    Matrix& out_weighted_adjacency
 ) {
     validate_square_matrix_or_throw(
         correlation_matrix,
@@ -37,25 +132,49 @@ Matrix build_weighted_graph(
         "correlation_matrix"
     );
 
-    Matrix weighted_adjacency(
-        static_cast<size_t>(number_of_assets) * number_of_assets,
-        0.0
+    Matrix& weighted_adjacency = out_weighted_adjacency;
+    weighted_adjacency.resize(
+        static_cast<size_t>(number_of_assets) * number_of_assets
     );
 
-    for (uint32_t i = 0; i < number_of_assets; ++i) {
-        for (uint32_t j = 0; j < number_of_assets; ++j) {
-            size_t index = static_cast<size_t>(i) * number_of_assets + j;
+    if (use_scalar_kernel_path()) {
+        for (uint32_t i = 0; i < number_of_assets; ++i) {
+            for (uint32_t j = 0; j < number_of_assets; ++j) {
+                size_t index = static_cast<size_t>(i) * number_of_assets + j;
 
-            if (i == j) {
-                weighted_adjacency[index] = 0.0;
-            } else {
-                weighted_adjacency[index] =
-                    std::max(correlation_matrix[index], 0.0);
+                if (i == j) {
+                    weighted_adjacency[index] = 0.0;
+                } else {
+                    weighted_adjacency[index] =
+                        std::max(correlation_matrix[index], 0.0);
+                }
             }
         }
+
+        return;
     }
 
-    return weighted_adjacency;
+    build_weighted_graph_vectorized_into(
+        correlation_matrix, number_of_assets, weighted_adjacency);
+}
+
+void build_weighted_graph_into(
+    const MatrixF& correlation_matrix,
+    uint32_t number_of_assets,
+    MatrixF& out_weighted_adjacency
+) {
+    validate_square_matrix_or_throw(
+        correlation_matrix,
+        number_of_assets,
+        "correlation_matrix"
+    );
+
+    out_weighted_adjacency.resize(
+        static_cast<size_t>(number_of_assets) * number_of_assets
+    );
+
+    build_weighted_graph_vectorized_into(
+        correlation_matrix, number_of_assets, out_weighted_adjacency);
 }
 
 Matrix compute_laplacian(
@@ -73,29 +192,387 @@ Matrix compute_laplacian(
         0.0
     );
 
+    if (use_scalar_kernel_path()) {
+        for (uint32_t i = 0; i < number_of_assets; ++i) {
+            double degree = 0.0;
+
+            for (uint32_t j = 0; j < number_of_assets; ++j) {
+                degree += weighted_adjacency[
+                    static_cast<size_t>(i) * number_of_assets + j
+                ];
+            }
+
+            for (uint32_t j = 0; j < number_of_assets; ++j) {
+                size_t index = static_cast<size_t>(i) * number_of_assets + j;
+
+                if (i == j) {
+                    laplacian[index] = degree;
+                } else {
+                    laplacian[index] = -weighted_adjacency[index];
+                }
+            }
+        }
+
+        return laplacian;
+    }
+
+    validate_all_finite_or_throw(weighted_adjacency, "weighted_adjacency");
+
+    Eigen::Map<const RowMajorMatrixXd> adjacency(
+        weighted_adjacency.data(), number_of_assets, number_of_assets);
+    Eigen::Map<RowMajorMatrixXd> laplacian_matrix(
+        laplacian.data(), number_of_assets, number_of_assets);
+
+    // L = D - W; the adjacency diagonal is zero so negating the whole
+    // matrix and overwriting the diagonal with the degrees is exact.
+    Eigen::VectorXd degrees = adjacency.rowwise().sum();
+    laplacian_matrix = -adjacency;
+    laplacian_matrix.diagonal() = degrees;
+
+    return laplacian;
+}
+
+void compute_laplacian_in_place(
+    Matrix& weighted_adjacency,
+    uint32_t number_of_assets
+) {
+    validate_square_matrix_or_throw(
+        weighted_adjacency,
+        number_of_assets,
+        "weighted_adjacency"
+    );
+
+    if (use_scalar_kernel_path()) {
+        for (uint32_t i = 0; i < number_of_assets; ++i) {
+            double degree = 0.0;
+
+            for (uint32_t j = 0; j < number_of_assets; ++j) {
+                degree += weighted_adjacency[
+                    static_cast<size_t>(i) * number_of_assets + j
+                ];
+            }
+
+            for (uint32_t j = 0; j < number_of_assets; ++j) {
+                size_t index = static_cast<size_t>(i) * number_of_assets + j;
+
+                if (i == j) {
+                    weighted_adjacency[index] = degree;
+                } else {
+                    weighted_adjacency[index] = -weighted_adjacency[index];
+                }
+            }
+        }
+
+        return;
+    }
+
+    compute_laplacian_in_place_vectorized(weighted_adjacency, number_of_assets);
+}
+
+void compute_laplacian_in_place(
+    MatrixF& weighted_adjacency,
+    uint32_t number_of_assets
+) {
+    validate_square_matrix_or_throw(
+        weighted_adjacency,
+        number_of_assets,
+        "weighted_adjacency"
+    );
+
+    compute_laplacian_in_place_vectorized(weighted_adjacency, number_of_assets);
+}
+
+static void validate_packed_matrix_or_throw(
+    const PackedLowerMatrix& packed_matrix,
+    uint32_t number_of_assets,
+    const std::string& matrix_name
+) {
+    const size_t expected_element_count = packed_lower_entry_count(number_of_assets);
+    if (packed_matrix.size() != expected_element_count) {
+        throw std::runtime_error(
+            matrix_name + " must have size N*(N-1)/2. Got size=" +
+            std::to_string(packed_matrix.size()) +
+            ", expected=" + std::to_string(expected_element_count) +
+            ", N=" + std::to_string(number_of_assets)
+        );
+    }
+    validate_all_finite_or_throw(packed_matrix, matrix_name);
+}
+
+void build_weighted_graph_packed_into(
+    const PackedLowerMatrix& correlation_packed,
+    uint32_t number_of_assets,
+    PackedLowerMatrix& out_weighted_adjacency_packed
+) {
+    validate_packed_matrix_or_throw(
+        correlation_packed, number_of_assets, "correlation_packed");
+
+    out_weighted_adjacency_packed.resize(correlation_packed.size());
+
+    // Same ReLU rule as the dense kernel; the zero adjacency diagonal
+    // is implicit in packed storage.
+    Eigen::Map<const Eigen::ArrayXd> correlation_values(
+        correlation_packed.data(),
+        static_cast<Eigen::Index>(correlation_packed.size()));
+    Eigen::Map<Eigen::ArrayXd> adjacency_values(
+        out_weighted_adjacency_packed.data(),
+        static_cast<Eigen::Index>(out_weighted_adjacency_packed.size()));
+
+    adjacency_values = correlation_values.max(0.0);
+}
+
+void compute_laplacian_from_packed_into(
+    const PackedLowerMatrix& weighted_adjacency_packed,
+    uint32_t number_of_assets,
+    Matrix& out_laplacian
+) {
+    validate_packed_matrix_or_throw(
+        weighted_adjacency_packed, number_of_assets, "weighted_adjacency_packed");
+
+    out_laplacian.assign(
+        static_cast<size_t>(number_of_assets) * number_of_assets, 0.0);
+
+    // One pass over the packed entries: each stored weight contributes
+    // the two symmetric off-diagonal entries and both endpoint degrees.
+    Vector degrees(number_of_assets, 0.0);
+    size_t packed_index = 0;
+    for (uint32_t i = 1; i < number_of_assets; ++i) {
+        for (uint32_t j = 0; j < i; ++j) {
+            const double weight = weighted_adjacency_packed[packed_index++];
+            out_laplacian[static_cast<size_t>(i) * number_of_assets + j] = -weight;
+            out_laplacian[static_cast<size_t>(j) * number_of_assets + i] = -weight;
+            degrees[i] += weight;
+            degrees[j] += weight;
+        }
+    }
+
     for (uint32_t i = 0; i < number_of_assets; ++i) {
-        double degree = 0.0;
+        out_laplacian[static_cast<size_t>(i) * number_of_assets + i] = degrees[i];
+    }
+}
+
+double compute_graph_total_variation_packed(
+    const Vector& latest_return,
+    const PackedLowerMatrix& weighted_adjacency_packed,
+    uint32_t number_of_assets
+) {
+    validate_vector_or_throw(latest_return, number_of_assets, "latest_return");
+    validate_packed_matrix_or_throw(
+        weighted_adjacency_packed, number_of_assets, "weighted_adjacency_packed");
+
+    double gtv = 0.0;
+    size_t packed_index = 0;
+    for (uint32_t i = 1; i < number_of_assets; ++i) {
+        const double return_i = latest_return[i];
+        for (uint32_t j = 0; j < i; ++j) {
+            const double return_difference = return_i - latest_return[j];
+            gtv += weighted_adjacency_packed[packed_index++] *
+                   return_difference * return_difference;
+        }
+    }
 
+    return gtv;
+}
+
+SparseMatrixCSR build_weighted_graph_sparse(
+    const Matrix& correlation_matrix,
+    uint32_t number_of_assets,
+    double weight_threshold,
+    uint32_t top_k_neighbors
+) {
+    validate_square_matrix_or_throw(
+        correlation_matrix,
+        number_of_assets,
+        "correlation_matrix"
+    );
+
+    if (weight_threshold < 0.0) {
+        throw std::runtime_error("weight_threshold must be >= 0");
+    }
+
+    validate_all_finite_or_throw(correlation_matrix, "correlation_matrix");
+
+    const size_t total_entries =
+        static_cast<size_t>(number_of_assets) * number_of_assets;
+
+    // Edge keep mask, symmetrized below when top-k selection is active.
+    std::vector<uint8_t> keep_edge(total_entries, 0);
+
+    for (uint32_t i = 0; i < number_of_assets; ++i) {
         for (uint32_t j = 0; j < number_of_assets; ++j) {
-            degree += weighted_adjacency[
-                static_cast<size_t>(i) * number_of_assets + j
-            ];
+            if (i == j) {
+                continue;
+            }
+            const size_t index = static_cast<size_t>(i) * number_of_assets + j;
+            const double weight = std::max(correlation_matrix[index], 0.0);
+            if (weight > weight_threshold) {
+                keep_edge[index] = 1;
+            }
+        }
+    }
+
+    if (top_k_neighbors > 0) {
+        // Restrict each row to its top-k weights, then symmetrize: an
+        // edge survives if it is in the top-k of either endpoint.
+        std::vector<uint8_t> in_top_k(total_entries, 0);
+        std::vector<std::pair<double, uint32_t>> row_weights;
+        row_weights.reserve(number_of_assets);
+
+        for (uint32_t i = 0; i < number_of_assets; ++i) {
+            row_weights.clear();
+            for (uint32_t j = 0; j < number_of_assets; ++j) {
+                const size_t index = static_cast<size_t>(i) * number_of_assets + j;
+                if (keep_edge[index]) {
+                    row_weights.emplace_back(correlation_matrix[index], j);
+                }
+            }
+
+            const size_t keep_count =
+                std::min(static_cast<size_t>(top_k_neighbors), row_weights.size());
+            std::partial_sort(
+                row_weights.begin(),
+                row_weights.begin() + keep_count,
+                row_weights.end(),
+                [](const std::pair<double, uint32_t>& a, const std::pair<double, uint32_t>& b) {
+                    return a.first > b.first;
+                }
+            );
+
+            for (size_t k = 0; k < keep_count; ++k) {
+                const uint32_t j = row_weights[k].second;
+                in_top_k[static_cast<size_t>(i) * number_of_assets + j] = 1;
+            }
         }
 
+        for (uint32_t i = 0; i < number_of_assets; ++i) {
+            for (uint32_t j = 0; j < number_of_assets; ++j) {
+                const size_t index = static_cast<size_t>(i) * number_of_assets + j;
+                const size_t mirror_index = static_cast<size_t>(j) * number_of_assets + i;
+                if (keep_edge[index] && !in_top_k[index] && !in_top_k[mirror_index]) {
+                    keep_edge[index] = 0;
+                }
+            }
+        }
+    }
+
+    SparseMatrixCSR adjacency;
+    adjacency.row_offsets.resize(static_cast<size_t>(number_of_assets) + 1, 0);
+
+    size_t edge_count = 0;
+    for (size_t index = 0; index < total_entries; ++index) {
+        if (keep_edge[index]) {
+            edge_count += 1;
+        }
+    }
+    adjacency.column_indices.reserve(edge_count);
+    adjacency.values.reserve(edge_count);
+
+    for (uint32_t i = 0; i < number_of_assets; ++i) {
         for (uint32_t j = 0; j < number_of_assets; ++j) {
-            size_t index = static_cast<size_t>(i) * number_of_assets + j;
+            const size_t index = static_cast<size_t>(i) * number_of_assets + j;
+            if (!keep_edge[index]) {
+                continue;
+            }
+            adjacency.column_indices.push_back(j);
+            adjacency.values.push_back(std::max(correlation_matrix[index], 0.0));
+        }
+        adjacency.row_offsets[static_cast<size_t>(i) + 1] = adjacency.values.size();
+    }
 
-            if (i == j) {
-                laplacian[index] = degree;
-            } else {
-                laplacian[index] = -weighted_adjacency[index];
+    return adjacency;
+}
+
+static void validate_csr_or_throw(
+    const SparseMatrixCSR& matrix,
+    uint32_t number_of_assets,
+    const std::string& name
+) {
+    if (matrix.row_offsets.size() != static_cast<size_t>(number_of_assets) + 1) {
+        throw std::runtime_error(name + " row_offsets must have size N + 1");
+    }
+    if (matrix.column_indices.size() != matrix.values.size()) {
+        throw std::runtime_error(name + " column_indices and values must have equal size");
+    }
+    if (matrix.row_offsets.back() != matrix.values.size()) {
+        throw std::runtime_error(name + " row_offsets must end at the value count");
+    }
+}
+
+SparseMatrixCSR compute_laplacian_sparse(
+    const SparseMatrixCSR& weighted_adjacency,
+    uint32_t number_of_assets
+) {
+    validate_csr_or_throw(weighted_adjacency, number_of_assets, "weighted_adjacency");
+
+    SparseMatrixCSR laplacian;
+    laplacian.row_offsets.resize(static_cast<size_t>(number_of_assets) + 1, 0);
+    // One extra diagonal entry per row on top of the adjacency entries.
+    laplacian.column_indices.reserve(weighted_adjacency.values.size() + number_of_assets);
+    laplacian.values.reserve(weighted_adjacency.values.size() + number_of_assets);
+
+    for (uint32_t i = 0; i < number_of_assets; ++i) {
+        const size_t row_begin = weighted_adjacency.row_offsets[i];
+        const size_t row_end = weighted_adjacency.row_offsets[static_cast<size_t>(i) + 1];
+
+        double degree = 0.0;
+        for (size_t k = row_begin; k < row_end; ++k) {
+            degree += weighted_adjacency.values[k];
+        }
+
+        bool diagonal_written = false;
+        for (size_t k = row_begin; k < row_end; ++k) {
+            const uint32_t j = weighted_adjacency.column_indices[k];
+            if (!diagonal_written && j > i) {
+                laplacian.column_indices.push_back(i);
+                laplacian.values.push_back(degree);
+                diagonal_written = true;
+            }
+            if (j == i) {
+                // Adjacency diagonals are zero by construction; fold any
+                // explicit entry into the degree slot.
+                laplacian.column_indices.push_back(i);
+                laplacian.values.push_back(degree - weighted_adjacency.values[k]);
+                diagonal_written = true;
+                continue;
             }
+            laplacian.column_indices.push_back(j);
+            laplacian.values.push_back(-weighted_adjacency.values[k]);
         }
+        if (!diagonal_written) {
+            laplacian.column_indices.push_back(i);
+            laplacian.values.push_back(degree);
+        }
+
+        laplacian.row_offsets[static_cast<size_t>(i) + 1] = laplacian.values.size();
     }
 
     return laplacian;
 }
 
+double compute_graph_total_variation_sparse(
+    const Vector& latest_return,
+    const SparseMatrixCSR& laplacian,
+    uint32_t number_of_assets
+) {
+    validate_vector_or_throw(latest_return, number_of_assets, "latest_return");
+    validate_csr_or_throw(laplacian, number_of_assets, "laplacian");
+
+    double gtv = 0.0;
+
+    for (uint32_t i = 0; i < number_of_assets; ++i) {
+        const size_t row_begin = laplacian.row_offsets[i];
+        const size_t row_end = laplacian.row_offsets[static_cast<size_t>(i) + 1];
+
+        double row_sum = 0.0;
+        for (size_t k = row_begin; k < row_end; ++k) {
+            row_sum += laplacian.values[k] * latest_return[laplacian.column_indices[k]];
+        }
+        gtv += latest_return[i] * row_sum;
+    }
+
+    return gtv;
+}
+
 double compute_graph_total_variation(
     const Vector& latest_return,
     const Matrix& laplacian,
@@ -123,3 +600,53 @@ double compute_graph_total_variation(
 
     return gtv;
 }
+
+double compute_graph_total_variation(
+    const VectorF& latest_return,
+    const MatrixF& laplacian,
+    uint32_t number_of_assets
+) {
+    validate_vector_or_throw(latest_return, number_of_assets, "latest_return");
+    validate_square_matrix_or_throw(laplacian, number_of_assets, "laplacian");
+
+    Eigen::Map<const RowMajorMatrix<float>> laplacian_matrix(
+        laplacian.data(), number_of_assets, number_of_assets);
+    Eigen::Map<const Eigen::VectorXf> returns(
+        latest_return.data(), number_of_assets);
+
+    const Eigen::VectorXf laplacian_times_return = laplacian_matrix * returns;
+    return static_cast<double>(returns.dot(laplacian_times_return));
+}
+
+double compute_graph_total_variation_matrix_free(
+    const Vector& latest_return,
+    const Matrix& correlation_matrix,
+    uint32_t number_of_assets
+) {
+    validate_vector_or_throw(latest_return, number_of_assets, "latest_return");
+    validate_square_matrix_or_throw(
+        correlation_matrix,
+        number_of_assets,
+        "correlation_matrix"
+    );
+    validate_all_finite_or_throw(correlation_matrix, "correlation_matrix");
+
+    Eigen::Map<const RowMajorMatrixXd> correlation(
+        correlation_matrix.data(), number_of_assets, number_of_assets);
+    Eigen::Map<const Eigen::VectorXd> returns(
+        latest_return.data(), number_of_assets);
+
+    // GTV = sum_{i<j} w_ij (r_i - r_j)^2 with w_ij = max(M_{ij}, 0),
+    // streamed one row segment (j > i) at a time.
+    double gtv = 0.0;
+
+    for (uint32_t i = 0; i + 1 < number_of_assets; ++i) {
+        const Eigen::Index tail_length =
+            static_cast<Eigen::Index>(number_of_assets) - i - 1;
+
+        gtv += (correlation.row(i).tail(tail_length).transpose().array().max(0.0) *
+                (returns.tail(tail_length).array() - returns(i)).square()).sum();
+    }
+
+    return gtv;
+}
@@ -0,0 +1,136 @@
+#include "io_async.hpp"
+
+#include <iostream>
+#include <utility>
+
+#include "correlation.hpp"
+#include "returns.hpp"
+#include "topology.hpp"
+
+AsyncArtifactWriter::AsyncArtifactWriter() {
+    worker_thread = std::thread(&AsyncArtifactWriter::worker_loop, this);
+}
+
+AsyncArtifactWriter::~AsyncArtifactWriter() {
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        shutdown_requested = true;
+    }
+    queue_condition.notify_all();
+    if (worker_thread.joinable()) {
+        worker_thread.join();
+    }
+
+    // A failure nobody collected via wait_for_pending: destructors must
+    // not throw, so report it instead of losing it silently.
+    if (first_failure) {
+        try {
+            std::rethrow_exception(first_failure);
+        } catch (const std::exception& e) {
+            std::cerr << "WARNING: async artifact write failed: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "WARNING: async artifact write failed" << std::endl;
+        }
+    }
+}
+
+void AsyncArtifactWriter::enqueue_returns_bin(
+    Matrix window_returns,
+    uint32_t number_of_assets,
+    uint32_t window_length,
+    std::string output_path
+) {
+    enqueue_task(
+        [returns_buffer = std::move(window_returns),
+         number_of_assets,
+         window_length,
+         path = std::move(output_path)]() {
+            save_returns_bin(returns_buffer, number_of_assets, window_length, path);
+        }
+    );
+}
+
+void AsyncArtifactWriter::enqueue_correlation_bin(
+    Matrix correlation_matrix,
+    uint32_t number_of_assets,
+    std::string output_path
+) {
+    enqueue_task(
+        [correlation_buffer = std::move(correlation_matrix),
+         number_of_assets,
+         path = std::move(output_path)]() {
+            save_correlation_bin(correlation_buffer, number_of_assets, path);
+        }
+    );
+}
+
+void AsyncArtifactWriter::enqueue_diagram_bin(
+    PersistenceDiagram diagram,
+    std::string output_path
+) {
+    enqueue_task(
+        [diagram_buffer = std::move(diagram),
+         path = std::move(output_path)]() {
+            save_diagram_bin(diagram_buffer, path);
+        }
+    );
+}
+
+void AsyncArtifactWriter::wait_for_pending() {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    drained_condition.wait(lock, [this]() {
+        return pending_writes.empty() && !write_in_progress;
+    });
+
+    if (first_failure) {
+        std::exception_ptr failure = first_failure;
+        first_failure = nullptr;
+        std::rethrow_exception(failure);
+    }
+}
+
+void AsyncArtifactWriter::enqueue_task(std::function<void()> write_task) {
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        pending_writes.push_back(std::move(write_task));
+    }
+    queue_condition.notify_one();
+}
+
+void AsyncArtifactWriter::worker_loop() {
+    while (true) {
+        std::function<void()> write_task;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_condition.wait(lock, [this]() {
+                return !pending_writes.empty() || shutdown_requested;
+            });
+
+            if (pending_writes.empty()) {
+                // Shutdown with a drained queue: done.
+                return;
+            }
+
+            write_task = std::move(pending_writes.front());
+            pending_writes.pop_front();
+            write_in_progress = true;
+        }
+
+        try {
+            write_task();
+        } catch (...) {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            if (!first_failure) {
+                first_failure = std::current_exception();
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            write_in_progress = false;
+            if (pending_writes.empty()) {
+                drained_condition.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,259 @@
+#include "io_cache.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "io_parquet.hpp"
+
+static const char kCacheMagic[8] = {'M', 'S', 'I', 'C', 'A', 'C', 'H', 'E'};
+static const uint32_t kCacheFormatVersion = 1;
+
+// Fixed header: magic + version + rows + columns + reserved.
+static const size_t kCacheHeaderSize = sizeof(kCacheMagic) + 4 * sizeof(uint32_t);
+
+PriceCacheView::PriceCacheView(PriceCacheView&& other) noexcept {
+    *this = std::move(other);
+}
+
+PriceCacheView& PriceCacheView::operator=(PriceCacheView&& other) noexcept {
+    if (this != &other) {
+        if (mapping_address != nullptr) {
+            munmap(mapping_address, mapping_size);
+        }
+        data = other.data;
+        number_of_rows = other.number_of_rows;
+        number_of_columns = other.number_of_columns;
+        tickers = std::move(other.tickers);
+        mapping_address = other.mapping_address;
+        mapping_size = other.mapping_size;
+
+        other.data = nullptr;
+        other.number_of_rows = 0;
+        other.number_of_columns = 0;
+        other.mapping_address = nullptr;
+        other.mapping_size = 0;
+    }
+    return *this;
+}
+
+PriceCacheView::~PriceCacheView() {
+    if (mapping_address != nullptr) {
+        munmap(mapping_address, mapping_size);
+    }
+}
+
+void write_close_prices_cache(
+    const Matrix& closing_prices,
+    uint32_t number_of_rows,
+    uint32_t number_of_columns,
+    const std::vector<std::string>& tickers,
+    const std::string& cache_path
+) {
+    const size_t expected_size =
+        static_cast<size_t>(number_of_rows) * static_cast<size_t>(number_of_columns);
+    if (closing_prices.size() != expected_size) {
+        throw std::runtime_error("closing_prices size mismatch for cache write");
+    }
+    if (!tickers.empty() && tickers.size() != number_of_columns) {
+        throw std::runtime_error("tickers must be empty or have one entry per column");
+    }
+
+    // Write to a temporary sibling and rename, so concurrent readers
+    // never see a half-written cache.
+    const std::string temporary_path = cache_path + ".tmp";
+
+    {
+        std::ofstream output_file(temporary_path, std::ios::binary);
+        if (!output_file.is_open()) {
+            throw std::runtime_error("Failed to open file for writing: " + temporary_path);
+        }
+
+        output_file.write(kCacheMagic, sizeof(kCacheMagic));
+        output_file.write(reinterpret_cast<const char*>(&kCacheFormatVersion), sizeof(uint32_t));
+        output_file.write(reinterpret_cast<const char*>(&number_of_rows), sizeof(uint32_t));
+        output_file.write(reinterpret_cast<const char*>(&number_of_columns), sizeof(uint32_t));
+        const uint32_t reserved = 0;
+        output_file.write(reinterpret_cast<const char*>(&reserved), sizeof(uint32_t));
+
+        output_file.write(
+            reinterpret_cast<const char*>(closing_prices.data()),
+            closing_prices.size() * sizeof(double)
+        );
+
+        const uint32_t ticker_count = static_cast<uint32_t>(tickers.size());
+        output_file.write(reinterpret_cast<const char*>(&ticker_count), sizeof(uint32_t));
+        for (const std::string& ticker : tickers) {
+            const uint32_t length = static_cast<uint32_t>(ticker.size());
+            output_file.write(reinterpret_cast<const char*>(&length), sizeof(uint32_t));
+            output_file.write(ticker.data(), length);
+        }
+
+        if (!output_file.good()) {
+            throw std::runtime_error("Error writing to file: " + temporary_path);
+        }
+    }
+
+    std::filesystem::rename(
+        std::filesystem::path(temporary_path),
+        std::filesystem::path(cache_path)
+    );
+}
+
+PriceCacheView read_close_prices_cached(const std::string& cache_path) {
+    const int file_descriptor = open(cache_path.c_str(), O_RDONLY);
+    if (file_descriptor < 0) {
+        throw std::runtime_error("Failed to open cache file: " + cache_path);
+    }
+
+    struct stat file_status {};
+    if (fstat(file_descriptor, &file_status) != 0) {
+        close(file_descriptor);
+        throw std::runtime_error("Failed to stat cache file: " + cache_path);
+    }
+    const size_t file_size = static_cast<size_t>(file_status.st_size);
+
+    if (file_size < kCacheHeaderSize) {
+        close(file_descriptor);
+        throw std::runtime_error("Cache file too small: " + cache_path);
+    }
+
+    void* mapping_address = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    // The mapping keeps its own reference; the descriptor can close now.
+    close(file_descriptor);
+    if (mapping_address == MAP_FAILED) {
+        throw std::runtime_error("Failed to mmap cache file: " + cache_path);
+    }
+
+    PriceCacheView view;
+    view.mapping_address = mapping_address;
+    view.mapping_size = file_size;
+
+    const char* cursor = static_cast<const char*>(mapping_address);
+
+    if (std::memcmp(cursor, kCacheMagic, sizeof(kCacheMagic)) != 0) {
+        throw std::runtime_error("Bad cache magic in: " + cache_path);
+    }
+    cursor += sizeof(kCacheMagic);
+
+    uint32_t version = 0;
+    std::memcpy(&version, cursor, sizeof(uint32_t));
+    cursor += sizeof(uint32_t);
+    if (version != kCacheFormatVersion) {
+        throw std::runtime_error("Unsupported cache version in: " + cache_path);
+    }
+
+    std::memcpy(&view.number_of_rows, cursor, sizeof(uint32_t));
+    cursor += sizeof(uint32_t);
+    std::memcpy(&view.number_of_columns, cursor, sizeof(uint32_t));
+    cursor += sizeof(uint32_t);
+    cursor += sizeof(uint32_t);  // reserved
+
+    const size_t value_count =
+        static_cast<size_t>(view.number_of_rows) * static_cast<size_t>(view.number_of_columns);
+    const size_t data_bytes = value_count * sizeof(double);
+    if (file_size < kCacheHeaderSize + data_bytes + sizeof(uint32_t)) {
+        throw std::runtime_error("Cache file truncated: " + cache_path);
+    }
+
+    view.data = reinterpret_cast<const double*>(cursor);
+    cursor += data_bytes;
+
+    uint32_t ticker_count = 0;
+    std::memcpy(&ticker_count, cursor, sizeof(uint32_t));
+    cursor += sizeof(uint32_t);
+
+    const char* mapping_end = static_cast<const char*>(mapping_address) + file_size;
+    view.tickers.reserve(ticker_count);
+    for (uint32_t ticker_index = 0; ticker_index < ticker_count; ++ticker_index) {
+        if (cursor + sizeof(uint32_t) > mapping_end) {
+            throw std::runtime_error("Cache ticker section truncated: " + cache_path);
+        }
+        uint32_t length = 0;
+        std::memcpy(&length, cursor, sizeof(uint32_t));
+        cursor += sizeof(uint32_t);
+        if (cursor + length > mapping_end) {
+            throw std::runtime_error("Cache ticker section truncated: " + cache_path);
+        }
+        view.tickers.emplace_back(cursor, length);
+        cursor += length;
+    }
+
+    return view;
+}
+
+uint64_t compute_bytes_hash_fnv1a(const void* data, size_t size) {
+    const uint64_t fnv_offset_basis = 1469598103934665603ULL;
+    const uint64_t fnv_prime = 1099511628211ULL;
+
+    uint64_t hash = fnv_offset_basis;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint64_t>(bytes[i]);
+        hash *= fnv_prime;
+    }
+    return hash;
+}
+
+uint64_t compute_file_hash_fnv1a(const std::string& path) {
+    std::ifstream input_file(path, std::ios::binary);
+    if (!input_file.is_open()) {
+        throw std::runtime_error("Failed to open file for hashing: " + path);
+    }
+
+    const uint64_t fnv_offset_basis = 1469598103934665603ULL;
+    const uint64_t fnv_prime = 1099511628211ULL;
+
+    uint64_t hash = fnv_offset_basis;
+    char buffer[64 * 1024];
+    while (input_file.read(buffer, sizeof(buffer)) || input_file.gcount() > 0) {
+        const std::streamsize bytes_read = input_file.gcount();
+        for (std::streamsize i = 0; i < bytes_read; ++i) {
+            hash ^= static_cast<uint64_t>(static_cast<unsigned char>(buffer[i]));
+            hash *= fnv_prime;
+        }
+    }
+    return hash;
+}
+
+std::string price_cache_path_for(const std::string& parquet_path) {
+    return parquet_path + ".mcache";
+}
+
+PriceCacheView read_close_prices_cached_or_build(const std::string& parquet_path) {
+    const std::string cache_path = price_cache_path_for(parquet_path);
+
+    const std::filesystem::path parquet_fs_path(parquet_path);
+    const std::filesystem::path cache_fs_path(cache_path);
+
+    const bool cache_is_fresh =
+        std::filesystem::exists(cache_fs_path) &&
+        std::filesystem::exists(parquet_fs_path) &&
+        std::filesystem::last_write_time(cache_fs_path) >=
+            std::filesystem::last_write_time(parquet_fs_path);
+
+    if (!cache_is_fresh) {
+        uint32_t number_of_rows = 0;
+        uint32_t number_of_columns = 0;
+        Matrix closing_prices = read_close_prices_parquet(
+            parquet_path,
+            number_of_rows,
+            number_of_columns
+        );
+        write_close_prices_cache(
+            closing_prices,
+            number_of_rows,
+            number_of_columns,
+            std::vector<std::string>(),
+            cache_path
+        );
+    }
+
+    return read_close_prices_cached(cache_path);
+}
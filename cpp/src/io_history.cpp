@@ -0,0 +1,244 @@
+#include "io_history.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+// File headers: magic + format version, both uint32. The record size is
+// also stored so a layout change is caught on read instead of producing
+// garbage rows.
+static const uint32_t kHistoryMagic = 0x4D534948;  // "MSIH"
+static const uint32_t kDiagramLogMagic = 0x4D534944;  // "MSID"
+static const uint32_t kHistoryVersion = 1;
+
+static void validate_finite_or_throw(double value, const std::string& name) {
+    if (!std::isfinite(value)) {
+        throw std::runtime_error(name + " is not finite");
+    }
+}
+
+/**
+ * @brief Open a history/log file for appending, writing the header when
+ *        the file is new and validating it otherwise.
+ */
+static std::ofstream open_for_append(
+    const std::string& path,
+    uint32_t magic,
+    uint32_t record_size
+) {
+    // Probe the existing header first (append mode cannot read).
+    {
+        std::ifstream existing_file(path, std::ios::binary);
+        if (existing_file.is_open()) {
+            uint32_t existing_magic = 0;
+            uint32_t existing_version = 0;
+            uint32_t existing_record_size = 0;
+            existing_file.read(reinterpret_cast<char*>(&existing_magic), sizeof(uint32_t));
+            existing_file.read(reinterpret_cast<char*>(&existing_version), sizeof(uint32_t));
+            existing_file.read(reinterpret_cast<char*>(&existing_record_size), sizeof(uint32_t));
+            if (!existing_file.good() ||
+                existing_magic != magic ||
+                existing_version != kHistoryVersion ||
+                existing_record_size != record_size) {
+                throw std::runtime_error("Unrecognized header in: " + path);
+            }
+
+            std::ofstream output_file(path, std::ios::binary | std::ios::app);
+            if (!output_file.is_open()) {
+                throw std::runtime_error("Failed to open file for appending: " + path);
+            }
+            return output_file;
+        }
+    }
+
+    std::ofstream output_file(path, std::ios::binary | std::ios::app);
+    if (!output_file.is_open()) {
+        throw std::runtime_error("Failed to open file for appending: " + path);
+    }
+    output_file.write(reinterpret_cast<const char*>(&magic), sizeof(uint32_t));
+    output_file.write(reinterpret_cast<const char*>(&kHistoryVersion), sizeof(uint32_t));
+    output_file.write(reinterpret_cast<const char*>(&record_size), sizeof(uint32_t));
+    if (!output_file.good()) {
+        throw std::runtime_error("Error writing header to: " + path);
+    }
+    return output_file;
+}
+
+/**
+ * @brief Open a history/log file for reading and consume the header.
+ */
+static std::ifstream open_validated(
+    const std::string& path,
+    uint32_t magic,
+    uint32_t record_size
+) {
+    std::ifstream input_file(path, std::ios::binary);
+    if (!input_file.is_open()) {
+        throw std::runtime_error("Failed to open file for reading: " + path);
+    }
+    uint32_t existing_magic = 0;
+    uint32_t existing_version = 0;
+    uint32_t existing_record_size = 0;
+    input_file.read(reinterpret_cast<char*>(&existing_magic), sizeof(uint32_t));
+    input_file.read(reinterpret_cast<char*>(&existing_version), sizeof(uint32_t));
+    input_file.read(reinterpret_cast<char*>(&existing_record_size), sizeof(uint32_t));
+    if (!input_file.good() ||
+        existing_magic != magic ||
+        existing_version != kHistoryVersion ||
+        existing_record_size != record_size) {
+        throw std::runtime_error("Unrecognized header in: " + path);
+    }
+    return input_file;
+}
+
+void append_strain_history(
+    const std::string& history_path,
+    const StrainComponents& components,
+    uint64_t diagram_offset,
+    uint64_t diagram_byte_count
+) {
+    StrainHistoryRecord record;
+    std::memset(&record, 0, sizeof(record));
+    if (components.date.size() >= sizeof(record.date)) {
+        throw std::runtime_error("date too long for history record: " + components.date);
+    }
+    std::memcpy(record.date, components.date.data(), components.date.size());
+    record.l2_return_magnitude = components.l2_return_magnitude;
+    record.graph_total_variation = components.graph_total_variation;
+    record.systemic_ratio = components.systemic_ratio;
+    record.total_persistence = components.total_persistence;
+    record.wasserstein_distance = components.wasserstein_distance;
+    record.strain_index = components.strain_index;
+    record.normalized_strain_index = components.normalized_strain_index;
+    record.diagram_offset = diagram_offset;
+    record.diagram_byte_count = diagram_byte_count;
+
+    std::ofstream output_file = open_for_append(
+        history_path, kHistoryMagic, sizeof(StrainHistoryRecord));
+    output_file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    if (!output_file.good()) {
+        throw std::runtime_error("Error writing to file: " + history_path);
+    }
+}
+
+std::vector<StrainHistoryRecord> read_strain_history(
+    const std::string& history_path
+) {
+    std::ifstream input_file = open_validated(
+        history_path, kHistoryMagic, sizeof(StrainHistoryRecord));
+
+    std::vector<StrainHistoryRecord> records;
+    StrainHistoryRecord record;
+    while (input_file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        records.push_back(record);
+    }
+    if (!input_file.eof() && input_file.gcount() != 0) {
+        throw std::runtime_error("Truncated record in: " + history_path);
+    }
+    return records;
+}
+
+bool find_latest_history_record_before(
+    const std::string& history_path,
+    const std::string& run_date,
+    StrainHistoryRecord& out_record
+) {
+    // A missing history file is the normal state of a fresh output
+    // tree, not an error.
+    {
+        std::ifstream probe(history_path, std::ios::binary);
+        if (!probe.is_open()) {
+            return false;
+        }
+    }
+
+    const std::vector<StrainHistoryRecord> records =
+        read_strain_history(history_path);
+
+    // Backwards so a superseding re-run of a day wins; YYYY-MM-DD
+    // compares chronologically as a string.
+    for (size_t i = records.size(); i > 0; --i) {
+        const StrainHistoryRecord& record = records[i - 1];
+        if (std::string(record.date) < run_date) {
+            out_record = record;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t append_diagram_log(
+    const std::string& diagram_log_path,
+    const PersistenceDiagram& diagram,
+    uint64_t& out_byte_count
+) {
+    if (diagram.size() > static_cast<size_t>(std::numeric_limits<uint32_t>::max())) {
+        throw std::runtime_error("diagram too large to serialize (exceeds uint32 pair count)");
+    }
+
+    // Record size 0 in the header marks variable-length records
+    // (addressed by offset, not index).
+    std::ofstream output_file = open_for_append(diagram_log_path, kDiagramLogMagic, 0);
+    output_file.seekp(0, std::ios::end);
+    const uint64_t record_offset = static_cast<uint64_t>(output_file.tellp());
+
+    // Same layout as the per-day diagram.bin: pair count, then
+    // birth/death doubles.
+    const uint32_t number_of_pairs = static_cast<uint32_t>(diagram.size());
+    output_file.write(reinterpret_cast<const char*>(&number_of_pairs), sizeof(uint32_t));
+    for (const PersistencePair& pair : diagram) {
+        validate_finite_or_throw(pair.birth, "diagram.birth");
+        validate_finite_or_throw(pair.death, "diagram.death");
+        output_file.write(reinterpret_cast<const char*>(&pair.birth), sizeof(double));
+        output_file.write(reinterpret_cast<const char*>(&pair.death), sizeof(double));
+    }
+    if (!output_file.good()) {
+        throw std::runtime_error("Error writing to file: " + diagram_log_path);
+    }
+
+    out_byte_count =
+        sizeof(uint32_t) + static_cast<uint64_t>(number_of_pairs) * 2 * sizeof(double);
+    return record_offset;
+}
+
+PersistenceDiagram read_diagram_log_at(
+    const std::string& diagram_log_path,
+    uint64_t diagram_offset,
+    uint64_t diagram_byte_count
+) {
+    std::ifstream input_file = open_validated(diagram_log_path, kDiagramLogMagic, 0);
+    input_file.seekg(static_cast<std::streamoff>(diagram_offset));
+
+    uint32_t number_of_pairs = 0;
+    input_file.read(reinterpret_cast<char*>(&number_of_pairs), sizeof(uint32_t));
+    if (!input_file.good()) {
+        throw std::runtime_error("Failed to read diagram header from: " + diagram_log_path);
+    }
+
+    const uint64_t expected_byte_count =
+        sizeof(uint32_t) + static_cast<uint64_t>(number_of_pairs) * 2 * sizeof(double);
+    if (expected_byte_count != diagram_byte_count) {
+        throw std::runtime_error(
+            "diagram record length mismatch in: " + diagram_log_path);
+    }
+
+    PersistenceDiagram diagram;
+    diagram.reserve(static_cast<size_t>(number_of_pairs));
+    for (uint32_t pair_index = 0; pair_index < number_of_pairs; ++pair_index) {
+        PersistencePair pair;
+        input_file.read(reinterpret_cast<char*>(&pair.birth), sizeof(double));
+        input_file.read(reinterpret_cast<char*>(&pair.death), sizeof(double));
+        if (!input_file.good()) {
+            throw std::runtime_error("Failed to read diagram pair from: " + diagram_log_path);
+        }
+        validate_finite_or_throw(pair.birth, "diagram.birth");
+        validate_finite_or_throw(pair.death, "diagram.death");
+        if (pair.death < pair.birth) {
+            throw std::runtime_error("diagram contains a pair with death < birth");
+        }
+        diagram.push_back(pair);
+    }
+    return diagram;
+}
@@ -5,13 +5,33 @@
 #include <arrow/io/api.h>
 #include <parquet/arrow/reader.h>
 
+#include <cmath>
 #include <iostream>
 #include <stdexcept>
 
-Matrix read_close_prices_parquet(
+// Columns that are not price data (date/index columns written by the
+// upstream exporter) are skipped by both readers below.
+static bool is_non_price_column(const std::string& column_name) {
+    return (column_name == "Date") ||
+           (column_name == "date") ||
+           (column_name.find("__index") != std::string::npos) ||
+           (column_name.find("index") == 0) ||
+           (column_name == "");
+}
+
+/**
+ * @brief Shared streaming reader behind the strict and masked variants.
+ *
+ * When out_valid is null, a null price aborts the read (the historical
+ * contract: pre-cleaned inputs). When out_valid points to a mask, null
+ * and non-finite cells become 0.0 with mask 0 and the read continues,
+ * so the raw warehouse export can be ingested directly.
+ */
+static Matrix read_close_prices_parquet_impl(
     const std::string& parquet_path,
     uint32_t& out_number_of_rows,
-    uint32_t& out_number_of_columns
+    uint32_t& out_number_of_columns,
+    ValidityMask* out_valid
 ) {
     // Step 1: Open the parquet file
     auto file_result = arrow::io::ReadableFile::Open(parquet_path);
@@ -33,81 +53,185 @@ Matrix read_close_prices_parquet(
         throw std::runtime_error("Failed to build parquet reader: " + build_status.ToString());
     }
 
-    // Step 3: Read entire file into Arrow table
-    std::shared_ptr<arrow::Table> table;
-    auto read_status = parquet_reader->ReadTable(&table);
-    if (!read_status.ok()) {
-        throw std::runtime_error("Failed to read parquet table: " + read_status.ToString());
+    // Step 3: Identify price columns from the schema alone, before any
+    // data is decoded (projection pushdown: skipped columns are never
+    // materialized).
+    std::shared_ptr<arrow::Schema> schema;
+    auto schema_status = parquet_reader->GetSchema(&schema);
+    if (!schema_status.ok()) {
+        throw std::runtime_error("Failed to read parquet schema: " + schema_status.ToString());
     }
 
-    // Step 4: Identify which columns are actual price data (skip date/index columns)
     std::vector<int> price_column_indices;
-    for (int col_idx = 0; col_idx < table->num_columns(); ++col_idx) {
-        std::string column_name = table->field(col_idx)->name();
-        
-        // Skip columns that are not price data
-        bool is_skip_column = (column_name == "Date") ||
-                              (column_name == "date") ||
-                              (column_name.find("__index") != std::string::npos) ||
-                              (column_name.find("index") == 0) ||
-                              (column_name == "");
-        
-        if (!is_skip_column) {
+    for (int col_idx = 0; col_idx < schema->num_fields(); ++col_idx) {
+        std::string column_name = schema->field(col_idx)->name();
+
+        if (!is_non_price_column(column_name)) {
             price_column_indices.push_back(col_idx);
         }
     }
 
-    // Step 5: Extract dimensions
-    int64_t number_of_rows = table->num_rows();
-    int number_of_columns = static_cast<int>(price_column_indices.size());
+    // Step 4: Extract dimensions from file metadata (no decode needed)
+    const int64_t number_of_rows =
+        parquet_reader->parquet_reader()->metadata()->num_rows();
+    const int number_of_columns = static_cast<int>(price_column_indices.size());
 
     out_number_of_rows = static_cast<uint32_t>(number_of_rows);
     out_number_of_columns = static_cast<uint32_t>(number_of_columns);
 
-    // Step 6: Allocate output matrix (row-major: rows x columns)
-    Matrix closing_prices(number_of_rows * number_of_columns);
-
-    // Step 7: Extract data from each price column (skipping index columns)
-    for (int output_col_idx = 0; output_col_idx < number_of_columns; ++output_col_idx) {
-        int source_col_idx = price_column_indices[output_col_idx];
-        std::shared_ptr<arrow::ChunkedArray> chunked_column = table->column(source_col_idx);
-        int64_t row_offset = 0;
-        const std::string column_name = table->field(source_col_idx)->name();
-        for (int chunk_index = 0; chunk_index < chunked_column->num_chunks(); ++chunk_index) {
-            std::shared_ptr<arrow::Array> chunk = chunked_column->chunk(chunk_index);
-
-            std::shared_ptr<arrow::Array> float64_array = chunk;
-            if (chunk->type_id() != arrow::Type::DOUBLE) {
-                auto cast_result = arrow::compute::Cast(chunk, arrow::float64());
-                if (!cast_result.status().ok()) {
-                    throw std::runtime_error("Failed to cast parquet column to float64");
+    // Step 5: Allocate output matrix (row-major: rows x columns)
+    Matrix closing_prices(
+        static_cast<size_t>(number_of_rows) * static_cast<size_t>(number_of_columns));
+    if (out_valid != nullptr) {
+        out_valid->assign(closing_prices.size(), 1);
+    }
+
+    // Step 6: Stream the file one row group at a time, decoding only the
+    // projected price columns and writing each chunk straight into the
+    // destination matrix. Peak memory is one row group, not the table.
+    const int number_of_row_groups =
+        parquet_reader->parquet_reader()->metadata()->num_row_groups();
+
+    int64_t row_group_row_offset = 0;
+    for (int row_group_index = 0; row_group_index < number_of_row_groups; ++row_group_index) {
+        std::shared_ptr<arrow::Table> row_group_table;
+        auto read_status = parquet_reader->ReadRowGroup(
+            row_group_index,
+            price_column_indices,
+            &row_group_table
+        );
+        if (!read_status.ok()) {
+            throw std::runtime_error(
+                "Failed to read parquet row group " + std::to_string(row_group_index) +
+                ": " + read_status.ToString()
+            );
+        }
+
+        const int64_t rows_in_group = row_group_table->num_rows();
+        if (row_group_row_offset + rows_in_group > number_of_rows) {
+            throw std::runtime_error("Parquet row group exceeds declared row count");
+        }
+
+        for (int output_col_idx = 0; output_col_idx < number_of_columns; ++output_col_idx) {
+            std::shared_ptr<arrow::ChunkedArray> chunked_column =
+                row_group_table->column(output_col_idx);
+            const std::string column_name =
+                row_group_table->field(output_col_idx)->name();
+
+            int64_t row_offset = row_group_row_offset;
+            for (int chunk_index = 0; chunk_index < chunked_column->num_chunks(); ++chunk_index) {
+                std::shared_ptr<arrow::Array> chunk = chunked_column->chunk(chunk_index);
+
+                std::shared_ptr<arrow::Array> float64_array = chunk;
+                if (chunk->type_id() != arrow::Type::DOUBLE) {
+                    auto cast_result = arrow::compute::Cast(chunk, arrow::float64());
+                    if (!cast_result.status().ok()) {
+                        throw std::runtime_error("Failed to cast parquet column to float64");
+                    }
+                    float64_array = cast_result->make_array();
                 }
-                float64_array = cast_result->make_array();
-            }
 
-            auto double_array = std::static_pointer_cast<arrow::DoubleArray>(float64_array);
-            for (int64_t row_in_chunk = 0; row_in_chunk < double_array->length(); ++row_in_chunk) {
-                if (double_array->IsNull(row_in_chunk)) {
+                auto double_array = std::static_pointer_cast<arrow::DoubleArray>(float64_array);
+                for (int64_t row_in_chunk = 0; row_in_chunk < double_array->length(); ++row_in_chunk) {
                     const int64_t global_row = row_offset + row_in_chunk;
-                    throw std::runtime_error(
-                        "Parquet contains null price value: file=" + parquet_path +
-                        ", column=" + column_name +
-                        ", row_index=" + std::to_string(global_row)
-                    );
+                    size_t matrix_index =
+                        static_cast<size_t>(global_row) * static_cast<size_t>(number_of_columns) +
+                        static_cast<size_t>(output_col_idx);
+
+                    const bool cell_is_null = double_array->IsNull(row_in_chunk);
+                    const double cell_value =
+                        cell_is_null ? 0.0 : double_array->Value(row_in_chunk);
+
+                    if (cell_is_null || !std::isfinite(cell_value)) {
+                        if (out_valid == nullptr) {
+                            throw std::runtime_error(
+                                "Parquet contains null price value: file=" + parquet_path +
+                                ", column=" + column_name +
+                                ", row_index=" + std::to_string(global_row)
+                            );
+                        }
+                        closing_prices[matrix_index] = 0.0;
+                        (*out_valid)[matrix_index] = 0;
+                        continue;
+                    }
+                    closing_prices[matrix_index] = cell_value;
                 }
-                const int64_t global_row = row_offset + row_in_chunk;
-                size_t matrix_index =
-                    static_cast<size_t>(global_row) * static_cast<size_t>(number_of_columns) +
-                    static_cast<size_t>(output_col_idx);
-                closing_prices[matrix_index] = double_array->Value(row_in_chunk);
+                row_offset += double_array->length();
             }
-            row_offset += double_array->length();
-        }
 
-        if (row_offset != number_of_rows) {
-            throw std::runtime_error("Parquet column length mismatch");
+            if (row_offset != row_group_row_offset + rows_in_group) {
+                throw std::runtime_error("Parquet column length mismatch");
+            }
         }
+
+        row_group_row_offset += rows_in_group;
+    }
+
+    if (row_group_row_offset != number_of_rows) {
+        throw std::runtime_error("Parquet row count mismatch across row groups");
     }
 
     return closing_prices;
 }
+
+Matrix read_close_prices_parquet(
+    const std::string& parquet_path,
+    uint32_t& out_number_of_rows,
+    uint32_t& out_number_of_columns
+) {
+    return read_close_prices_parquet_impl(
+        parquet_path, out_number_of_rows, out_number_of_columns, nullptr);
+}
+
+Matrix read_close_prices_parquet_masked(
+    const std::string& parquet_path,
+    uint32_t& out_number_of_rows,
+    uint32_t& out_number_of_columns,
+    ValidityMask& out_valid
+) {
+    return read_close_prices_parquet_impl(
+        parquet_path, out_number_of_rows, out_number_of_columns, &out_valid);
+}
+
+std::vector<std::string> read_close_prices_column_names(
+    const std::string& parquet_path
+) {
+    // Step 1: Open the parquet file
+    auto file_result = arrow::io::ReadableFile::Open(parquet_path);
+    if (!file_result.ok()) {
+        throw std::runtime_error("Failed to open parquet file: " + parquet_path);
+    }
+    std::shared_ptr<arrow::io::ReadableFile> input_file = file_result.ValueOrDie();
+
+    // Step 2: Create parquet reader using the builder pattern (newer API)
+    parquet::arrow::FileReaderBuilder reader_builder;
+    auto builder_status = reader_builder.Open(input_file);
+    if (!builder_status.ok()) {
+        throw std::runtime_error("Failed to open parquet reader: " + builder_status.ToString());
+    }
+
+    std::unique_ptr<parquet::arrow::FileReader> parquet_reader;
+    auto build_status = reader_builder.Build(&parquet_reader);
+    if (!build_status.ok()) {
+        throw std::runtime_error("Failed to build parquet reader: " + build_status.ToString());
+    }
+
+    // Step 3: Collect price column names from the schema alone; no row
+    // data is ever decoded.
+    std::shared_ptr<arrow::Schema> schema;
+    auto schema_status = parquet_reader->GetSchema(&schema);
+    if (!schema_status.ok()) {
+        throw std::runtime_error("Failed to read parquet schema: " + schema_status.ToString());
+    }
+
+    std::vector<std::string> price_column_names;
+    for (int col_idx = 0; col_idx < schema->num_fields(); ++col_idx) {
+        std::string column_name = schema->field(col_idx)->name();
+
+        if (!is_non_price_column(column_name)) {
+            price_column_names.push_back(column_name);
+        }
+    }
+
+    return price_column_names;
+}
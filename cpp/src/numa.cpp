@@ -0,0 +1,179 @@
+#include "numa.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @brief Parse a kernel cpulist string ("0-15,32-47") into CPU indices.
+ */
+static std::vector<uint32_t> parse_cpulist(const std::string& cpulist) {
+    std::vector<uint32_t> cpu_indices;
+    std::stringstream list_stream(cpulist);
+    std::string range_token;
+    while (std::getline(list_stream, range_token, ',')) {
+        if (range_token.empty()) {
+            continue;
+        }
+        const size_t dash_position = range_token.find('-');
+        if (dash_position == std::string::npos) {
+            cpu_indices.push_back(
+                static_cast<uint32_t>(std::stoul(range_token)));
+            continue;
+        }
+        const uint32_t first_cpu = static_cast<uint32_t>(
+            std::stoul(range_token.substr(0, dash_position)));
+        const uint32_t last_cpu = static_cast<uint32_t>(
+            std::stoul(range_token.substr(dash_position + 1)));
+        if (last_cpu < first_cpu) {
+            throw std::runtime_error("Invalid cpulist range: " + range_token);
+        }
+        for (uint32_t cpu = first_cpu; cpu <= last_cpu; ++cpu) {
+            cpu_indices.push_back(cpu);
+        }
+    }
+    return cpu_indices;
+}
+
+uint32_t pin_threads_to_numa_node(uint32_t numa_node) {
+#ifdef __linux__
+    const std::string cpulist_path =
+        "/sys/devices/system/node/node" + std::to_string(numa_node) +
+        "/cpulist";
+    std::ifstream cpulist_file(cpulist_path);
+    if (!cpulist_file.is_open()) {
+        throw std::runtime_error(
+            "NUMA node " + std::to_string(numa_node) +
+            " not present (failed to read " + cpulist_path + ")");
+    }
+    std::string cpulist;
+    std::getline(cpulist_file, cpulist);
+
+    const std::vector<uint32_t> cpu_indices = parse_cpulist(cpulist);
+    if (cpu_indices.empty()) {
+        throw std::runtime_error(
+            "NUMA node " + std::to_string(numa_node) + " has no CPUs");
+    }
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (uint32_t cpu : cpu_indices) {
+        CPU_SET(static_cast<int>(cpu), &cpu_set);
+    }
+    if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+        throw std::runtime_error(
+            "sched_setaffinity failed for NUMA node " +
+            std::to_string(numa_node));
+    }
+    return static_cast<uint32_t>(cpu_indices.size());
+#else
+    (void)numa_node;
+    throw std::runtime_error("--numa-node is only supported on Linux");
+#endif
+}
+
+void advise_huge_pages(void* data, size_t size_in_bytes) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    const long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size <= 0 || data == nullptr || size_in_bytes == 0) {
+        return;
+    }
+    const uintptr_t page_mask = static_cast<uintptr_t>(page_size) - 1;
+    const uintptr_t begin =
+        (reinterpret_cast<uintptr_t>(data) + page_mask) & ~page_mask;
+    const uintptr_t end =
+        (reinterpret_cast<uintptr_t>(data) + size_in_bytes) & ~page_mask;
+    if (end > begin) {
+        // Best-effort: ignored when THP is disabled system-wide.
+        madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+    }
+#else
+    (void)data;
+    (void)size_in_bytes;
+#endif
+}
+
+template <typename Scalar>
+static void first_touch_resize_impl(
+    std::vector<Scalar>& buffer,
+    size_t element_count
+) {
+    if (buffer.capacity() >= element_count) {
+        buffer.resize(element_count);
+        return;
+    }
+
+    std::vector<Scalar> fresh_buffer;
+    fresh_buffer.reserve(element_count);
+    advise_huge_pages(fresh_buffer.data(), element_count * sizeof(Scalar));
+
+#if defined(__linux__) && defined(MADV_POPULATE_WRITE) && defined(_OPENMP)
+    // Prefault each thread's contiguous share of the reserved storage
+    // through madvise(MADV_POPULATE_WRITE): the kernel populates those
+    // pages as if the calling thread had write-faulted them, so
+    // placement follows the same contiguous split the row-parallel
+    // kernels use without the process ever touching a vector element
+    // past size(). Best-effort like advise_huge_pages: on kernels
+    // without the flag the pages are simply faulted (serially) by the
+    // resize below.
+    const long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size > 0) {
+        const uintptr_t page_mask = static_cast<uintptr_t>(page_size) - 1;
+        const uintptr_t base =
+            reinterpret_cast<uintptr_t>(fresh_buffer.data());
+        const uintptr_t begin = (base + page_mask) & ~page_mask;
+        const uintptr_t end =
+            (base + element_count * sizeof(Scalar)) & ~page_mask;
+        if (end > begin) {
+            const size_t page_count =
+                (end - begin) / static_cast<size_t>(page_size);
+            #pragma omp parallel
+            {
+                const size_t thread_count =
+                    static_cast<size_t>(omp_get_num_threads());
+                const size_t thread_index =
+                    static_cast<size_t>(omp_get_thread_num());
+                const size_t pages_per_thread =
+                    (page_count + thread_count - 1) / thread_count;
+                const size_t first_page = thread_index * pages_per_thread;
+                const size_t last_page =
+                    std::min(page_count, first_page + pages_per_thread);
+                if (last_page > first_page) {
+                    madvise(
+                        reinterpret_cast<void*>(
+                            begin +
+                            first_page * static_cast<size_t>(page_size)),
+                        (last_page - first_page) *
+                            static_cast<size_t>(page_size),
+                        MADV_POPULATE_WRITE);
+                }
+            }
+        }
+    }
+#endif
+
+    fresh_buffer.resize(element_count);
+    buffer.swap(fresh_buffer);
+}
+
+void first_touch_resize(Matrix& buffer, size_t element_count) {
+    first_touch_resize_impl(buffer, element_count);
+}
+
+void first_touch_resize(MatrixF& buffer, size_t element_count) {
+    first_touch_resize_impl(buffer, element_count);
+}
@@ -0,0 +1,70 @@
+#include "perf.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include <sys/resource.h>
+
+long current_peak_rss_kb() {
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    // ru_maxrss is in kilobytes on Linux.
+    return usage.ru_maxrss;
+}
+
+ScopedStageTimer::ScopedStageTimer(PerfReport& report, const std::string& stage_name)
+    : report_(report),
+      stage_name_(stage_name),
+      start_time_(std::chrono::steady_clock::now()),
+      peak_rss_before_kb_(current_peak_rss_kb()) {}
+
+ScopedStageTimer::~ScopedStageTimer() {
+    const double wall_time_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start_time_
+    ).count();
+
+    StageTiming timing;
+    timing.stage_name = stage_name_;
+    timing.wall_time_ms = wall_time_ms;
+    timing.peak_rss_delta_kb = current_peak_rss_kb() - peak_rss_before_kb_;
+    report_.stages.push_back(timing);
+}
+
+void write_perf_json(
+    const PerfReport& report,
+    const std::string& output_path
+) {
+    std::ofstream output_file(output_path);
+    if (!output_file.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + output_path);
+    }
+
+    output_file << std::setprecision(17);
+
+    output_file << "{\n";
+    output_file << "  \"date\": \"" << report.date << "\",\n";
+    output_file << "  \"number_of_assets\": " << report.number_of_assets << ",\n";
+    output_file << "  \"window_length\": " << report.window_length << ",\n";
+    output_file << "  \"diagram_pair_count\": " << report.diagram_pair_count << ",\n";
+    output_file << "  \"stages\": [\n";
+
+    for (size_t i = 0; i < report.stages.size(); ++i) {
+        const StageTiming& timing = report.stages[i];
+        output_file << "    {\"stage\": \"" << timing.stage_name << "\", "
+                    << "\"wall_time_ms\": " << timing.wall_time_ms << ", "
+                    << "\"peak_rss_delta_kb\": " << timing.peak_rss_delta_kb << "}"
+                    << (i + 1 < report.stages.size() ? "," : "") << "\n";
+    }
+
+    output_file << "  ]\n";
+    output_file << "}\n";
+
+    if (!output_file.good()) {
+        throw std::runtime_error("Error writing to file: " + output_path);
+    }
+
+    output_file.close();
+}
@@ -0,0 +1,171 @@
+#include "preview.hpp"
+
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+static std::string trim_whitespace(const std::string& text) {
+    const char* whitespace = " \t\r\n";
+    const size_t first = text.find_first_not_of(whitespace);
+    const size_t last = text.find_last_not_of(whitespace);
+    if (first == std::string::npos) {
+        return std::string();
+    }
+    return text.substr(first, last - first + 1);
+}
+
+SectorMapping load_sector_mapping_csv(
+    const std::string& csv_path,
+    const std::vector<std::string>& tickers
+) {
+    std::ifstream input_file(csv_path);
+    if (!input_file.is_open()) {
+        throw std::runtime_error("Failed to open sector mapping: " + csv_path);
+    }
+
+    std::map<std::string, std::string> sector_of_ticker;
+    std::string line;
+    bool is_first_line = true;
+
+    while (std::getline(input_file, line)) {
+        line = trim_whitespace(line);
+        if (line.empty()) {
+            continue;
+        }
+
+        const size_t comma = line.find(',');
+        if (comma == std::string::npos) {
+            throw std::runtime_error("Malformed sector mapping line (expected ticker,sector): " + line);
+        }
+
+        const std::string ticker = trim_whitespace(line.substr(0, comma));
+        const std::string sector = trim_whitespace(line.substr(comma + 1));
+
+        // Tolerate a "ticker,sector" header row.
+        if (is_first_line && ticker == "ticker") {
+            is_first_line = false;
+            continue;
+        }
+        is_first_line = false;
+
+        if (ticker.empty() || sector.empty()) {
+            throw std::runtime_error("Malformed sector mapping line (empty field): " + line);
+        }
+
+        sector_of_ticker[ticker] = sector;
+    }
+
+    SectorMapping mapping;
+    mapping.sector_of_asset.resize(tickers.size());
+
+    std::map<std::string, uint32_t> sector_index_of_name;
+
+    for (size_t asset_index = 0; asset_index < tickers.size(); ++asset_index) {
+        const auto entry = sector_of_ticker.find(tickers[asset_index]);
+        // Unknown tickers degrade into a synthetic catch-all sector
+        // rather than failing the preview on a stale mapping file.
+        const std::string sector_name =
+            (entry != sector_of_ticker.end()) ? entry->second : std::string("UNMAPPED");
+
+        auto index_entry = sector_index_of_name.find(sector_name);
+        if (index_entry == sector_index_of_name.end()) {
+            const uint32_t new_index = static_cast<uint32_t>(mapping.sector_names.size());
+            sector_index_of_name[sector_name] = new_index;
+            mapping.sector_names.push_back(sector_name);
+            index_entry = sector_index_of_name.find(sector_name);
+        }
+
+        mapping.sector_of_asset[asset_index] = index_entry->second;
+    }
+
+    mapping.number_of_sectors = static_cast<uint32_t>(mapping.sector_names.size());
+    if (mapping.number_of_sectors == 0) {
+        throw std::runtime_error("sector mapping produced zero sectors: " + csv_path);
+    }
+
+    return mapping;
+}
+
+Matrix aggregate_correlation_by_sector(
+    const Matrix& correlation_matrix,
+    uint32_t number_of_assets,
+    const SectorMapping& mapping
+) {
+    const size_t expected_size =
+        static_cast<size_t>(number_of_assets) * number_of_assets;
+    if (correlation_matrix.size() != expected_size) {
+        throw std::runtime_error("correlation_matrix must be N x N");
+    }
+    if (mapping.sector_of_asset.size() != number_of_assets) {
+        throw std::runtime_error("sector mapping must cover all N assets");
+    }
+
+    const uint32_t number_of_sectors = mapping.number_of_sectors;
+    const size_t block_count =
+        static_cast<size_t>(number_of_sectors) * number_of_sectors;
+
+    Matrix block_sums(block_count, 0.0);
+    std::vector<size_t> block_pair_counts(block_count, 0);
+
+    // One streaming pass over the full matrix; self-pairs (i == j) are
+    // excluded so the trivial unit diagonal does not bias blocks.
+    for (uint32_t i = 0; i < number_of_assets; ++i) {
+        const uint32_t sector_i = mapping.sector_of_asset[i];
+        for (uint32_t j = 0; j < number_of_assets; ++j) {
+            if (i == j) {
+                continue;
+            }
+            const uint32_t sector_j = mapping.sector_of_asset[j];
+            const size_t block_index =
+                static_cast<size_t>(sector_i) * number_of_sectors + sector_j;
+            block_sums[block_index] +=
+                correlation_matrix[static_cast<size_t>(i) * number_of_assets + j];
+            block_pair_counts[block_index] += 1;
+        }
+    }
+
+    Matrix sector_correlation(block_count, 0.0);
+    for (size_t block_index = 0; block_index < block_count; ++block_index) {
+        if (block_pair_counts[block_index] > 0) {
+            sector_correlation[block_index] =
+                block_sums[block_index] / static_cast<double>(block_pair_counts[block_index]);
+        }
+    }
+
+    // A sector is fully correlated with itself at preview granularity.
+    for (uint32_t a = 0; a < number_of_sectors; ++a) {
+        sector_correlation[static_cast<size_t>(a) * number_of_sectors + a] = 1.0;
+    }
+
+    return sector_correlation;
+}
+
+Vector aggregate_vector_by_sector(
+    const Vector& values,
+    uint32_t number_of_assets,
+    const SectorMapping& mapping
+) {
+    if (values.size() != number_of_assets) {
+        throw std::runtime_error("values must have size N");
+    }
+    if (mapping.sector_of_asset.size() != number_of_assets) {
+        throw std::runtime_error("sector mapping must cover all N assets");
+    }
+
+    Vector sector_means(mapping.number_of_sectors, 0.0);
+    std::vector<size_t> sector_counts(mapping.number_of_sectors, 0);
+
+    for (uint32_t i = 0; i < number_of_assets; ++i) {
+        const uint32_t sector = mapping.sector_of_asset[i];
+        sector_means[sector] += values[i];
+        sector_counts[sector] += 1;
+    }
+
+    for (uint32_t a = 0; a < mapping.number_of_sectors; ++a) {
+        if (sector_counts[a] > 0) {
+            sector_means[a] /= static_cast<double>(sector_counts[a]);
+        }
+    }
+
+    return sector_means;
+}
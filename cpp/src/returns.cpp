@@ -1,20 +1,49 @@
 #include "returns.hpp"
 
 #include <cmath>
+#include <cstdlib>
 #include <fstream>
 #include <stdexcept>
 
+#include <Eigen/Dense>
+
+/**
+ * @brief True if the scalar reference kernel was requested.
+ *
+ * Same switch as graph.cpp and topology.cpp: the vectorized Eigen
+ * kernel is the default, MSI_SCALAR_KERNELS=1 restores the original
+ * per-element loop.
+ */
+static bool use_scalar_kernel_path() {
+    const char* value = std::getenv("MSI_SCALAR_KERNELS");
+    return value != nullptr && value[0] == '1';
+}
+
+using RowMajorMatrixXd =
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
 Returns compute_log_returns(
     const Matrix& closing_prices,
     uint32_t number_of_assets,
     uint32_t window_length
+) {
+    Returns result;
+    compute_log_returns_into(closing_prices, number_of_assets, window_length, result);
+    return result;
+}
+
+void compute_log_returns_into(
+    const Matrix& closing_prices,
+    uint32_t number_of_assets,
+    uint32_t window_length,
+    Returns& out_returns
 ) {
     // Validate inputs
     size_t expected_size =
         static_cast<size_t>(window_length + 1) * static_cast<size_t>(number_of_assets);
     if (closing_prices.size() != expected_size) {
-        throw std::runtime_error("closing_prices size mismatch: expected " + 
-                                 std::to_string(expected_size) + 
+        throw std::runtime_error("closing_prices size mismatch: expected " +
+                                 std::to_string(expected_size) +
                                  ", got " + std::to_string(closing_prices.size()));
     }
 
@@ -26,10 +55,40 @@ Returns compute_log_returns(
     // closing_prices provides (window_length + 1) price rows.
     uint32_t number_of_return_days = window_length;
 
-    // Allocate output matrix: [number_of_return_days x number_of_assets]
-    Matrix window_returns(
+    Matrix& window_returns = out_returns.window_returns;
+    Vector& latest_return = out_returns.latest_return;
+    window_returns.resize(
         static_cast<size_t>(number_of_return_days) * static_cast<size_t>(number_of_assets)
     );
+    latest_return.resize(number_of_assets);
+
+    if (!use_scalar_kernel_path()) {
+        // Single vectorized positivity scan instead of a branch per element.
+        Eigen::Map<const Eigen::ArrayXd> price_values(
+            closing_prices.data(),
+            static_cast<Eigen::Index>(closing_prices.size())
+        );
+        if (!(price_values > 0.0).all()) {
+            throw std::runtime_error("Invalid price: prices must be positive for log returns");
+        }
+
+        Eigen::Map<const RowMajorMatrixXd> prices(
+            closing_prices.data(), window_length + 1, number_of_assets);
+        Eigen::Map<RowMajorMatrixXd> returns_matrix(
+            window_returns.data(), number_of_return_days, number_of_assets);
+
+        // r_{t,i} = log(P_{t,i} / P_{t-1,i}), whole rows at a time.
+        returns_matrix =
+            (prices.bottomRows(window_length).array() /
+             prices.topRows(window_length).array()).log();
+
+        // Fused latest-return extraction: the last return row is the
+        // latest return, no separate pass over the prices needed.
+        Eigen::Map<Eigen::VectorXd> latest(latest_return.data(), number_of_assets);
+        latest = returns_matrix.row(number_of_return_days - 1);
+
+        return;
+    }
 
     // Compute log returns: r_{t,i} = log(P_{t,i} / P_{t-1,i})
     for (uint32_t day_index = 0; day_index < number_of_return_days; ++day_index) {
@@ -57,18 +116,10 @@ Returns compute_log_returns(
     }
 
     // Extract latest return vector (last row of window_returns)
-    Vector latest_return(number_of_assets);
     size_t last_row_start = (number_of_return_days - 1) * number_of_assets;
     for (uint32_t asset_index = 0; asset_index < number_of_assets; ++asset_index) {
         latest_return[asset_index] = window_returns[last_row_start + asset_index];
     }
-
-    // Build and return the result
-    Returns result;
-    result.window_returns = std::move(window_returns);
-    result.latest_return = std::move(latest_return);
-
-    return result;
 }
 
 void save_returns_bin(
@@ -98,3 +149,76 @@ void save_returns_bin(
 
     output_file.close();
 }
+
+void compute_log_returns_masked_into(
+    const Matrix& closing_prices,
+    const ValidityMask& price_valid,
+    uint32_t number_of_assets,
+    uint32_t window_length,
+    Returns& out_returns,
+    ValidityMask& out_return_valid
+) {
+    size_t expected_size =
+        static_cast<size_t>(window_length + 1) * static_cast<size_t>(number_of_assets);
+    if (closing_prices.size() != expected_size) {
+        throw std::runtime_error("closing_prices size mismatch: expected " +
+                                 std::to_string(expected_size) +
+                                 ", got " + std::to_string(closing_prices.size()));
+    }
+    if (price_valid.size() != expected_size) {
+        throw std::runtime_error("price_valid size mismatch: expected " +
+                                 std::to_string(expected_size) +
+                                 ", got " + std::to_string(price_valid.size()));
+    }
+    if (window_length < 1) {
+        throw std::runtime_error("window_length must be at least 1 to compute returns");
+    }
+
+    const uint32_t number_of_return_days = window_length;
+    const size_t return_count =
+        static_cast<size_t>(number_of_return_days) * static_cast<size_t>(number_of_assets);
+
+    Matrix& window_returns = out_returns.window_returns;
+    Vector& latest_return = out_returns.latest_return;
+    window_returns.resize(return_count);
+    latest_return.resize(number_of_assets);
+    out_return_valid.resize(return_count);
+
+    // A return needs both endpoint prices observed and positive; a
+    // masked or degenerate price yields a masked 0.0 return rather
+    // than throwing, which is the whole point of this variant.
+    for (uint32_t return_row = 0; return_row < number_of_return_days; ++return_row) {
+        const size_t previous_price_offset =
+            static_cast<size_t>(return_row) * number_of_assets;
+        const size_t current_price_offset =
+            static_cast<size_t>(return_row + 1) * number_of_assets;
+        const size_t return_offset =
+            static_cast<size_t>(return_row) * number_of_assets;
+
+        for (uint32_t asset_index = 0; asset_index < number_of_assets; ++asset_index) {
+            const double previous_price = closing_prices[previous_price_offset + asset_index];
+            const double current_price = closing_prices[current_price_offset + asset_index];
+            const bool both_observed =
+                price_valid[previous_price_offset + asset_index] != 0 &&
+                price_valid[current_price_offset + asset_index] != 0;
+
+            if (both_observed && previous_price > 0.0 && current_price > 0.0) {
+                window_returns[return_offset + asset_index] =
+                    std::log(current_price / previous_price);
+                out_return_valid[return_offset + asset_index] = 1;
+            } else {
+                window_returns[return_offset + asset_index] = 0.0;
+                out_return_valid[return_offset + asset_index] = 0;
+            }
+        }
+    }
+
+    // Latest return is the last return row, masked zeros included: an
+    // unobserved asset contributes nothing downstream, the same
+    // convention the zero-variance guard uses.
+    const size_t last_row_offset =
+        static_cast<size_t>(number_of_return_days - 1) * number_of_assets;
+    for (uint32_t asset_index = 0; asset_index < number_of_assets; ++asset_index) {
+        latest_return[asset_index] = window_returns[last_row_offset + asset_index];
+    }
+}
@@ -88,3 +88,106 @@ void write_strain_json(
 
     output_file.close();
 }
+
+// Normalization state file: magic + version, then the Welford moments
+// and the last folded-in date as a fixed NUL-padded field.
+static const uint32_t kNormalizationMagic = 0x4D53494E;  // "MSIN"
+static const uint32_t kNormalizationVersion = 1;
+static const size_t kNormalizationDateBytes = 16;
+
+void update_normalization_state(
+    NormalizationState& state,
+    double strain_index,
+    const std::string& run_date
+) {
+    if (std::isnan(strain_index) || std::isinf(strain_index)) {
+        throw std::runtime_error("strain_index must be finite for normalization state");
+    }
+    if (run_date.size() >= kNormalizationDateBytes) {
+        throw std::runtime_error("run_date too long for normalization state: " + run_date);
+    }
+
+    // YYYY-MM-DD compares chronologically as a string; a re-run of an
+    // already-counted day must not shift the moments.
+    if (!state.last_date.empty() && run_date <= state.last_date) {
+        return;
+    }
+
+    state.count += 1;
+    const double delta = strain_index - state.mean;
+    state.mean += delta / static_cast<double>(state.count);
+    state.m2 += delta * (strain_index - state.mean);
+    state.last_date = run_date;
+}
+
+double normalization_state_std_pop(const NormalizationState& state) {
+    if (state.count < 2) {
+        return 0.0;
+    }
+    return std::sqrt(state.m2 / static_cast<double>(state.count));
+}
+
+NormalizationState load_normalization_state_bin(const std::string& input_path) {
+    std::ifstream input_file(input_path, std::ios::binary);
+    if (!input_file.is_open()) {
+        return NormalizationState{};
+    }
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    input_file.read(reinterpret_cast<char*>(&magic), sizeof(uint32_t));
+    input_file.read(reinterpret_cast<char*>(&version), sizeof(uint32_t));
+    if (!input_file.good() ||
+        magic != kNormalizationMagic ||
+        version != kNormalizationVersion) {
+        throw std::runtime_error("Unrecognized normalization state header in: " + input_path);
+    }
+
+    NormalizationState state;
+    char date_bytes[kNormalizationDateBytes] = {};
+    input_file.read(reinterpret_cast<char*>(&state.count), sizeof(uint64_t));
+    input_file.read(reinterpret_cast<char*>(&state.mean), sizeof(double));
+    input_file.read(reinterpret_cast<char*>(&state.m2), sizeof(double));
+    input_file.read(date_bytes, kNormalizationDateBytes);
+    if (!input_file.good()) {
+        throw std::runtime_error("Failed to read normalization state from: " + input_path);
+    }
+    date_bytes[kNormalizationDateBytes - 1] = '\0';
+    state.last_date = std::string(date_bytes);
+
+    if (std::isnan(state.mean) || std::isinf(state.mean) ||
+        std::isnan(state.m2) || std::isinf(state.m2) || state.m2 < 0.0) {
+        throw std::runtime_error("Corrupt normalization state in: " + input_path);
+    }
+    return state;
+}
+
+void save_normalization_state_bin(
+    const NormalizationState& state,
+    const std::string& output_path
+) {
+    if (state.last_date.size() >= kNormalizationDateBytes) {
+        throw std::runtime_error("last_date too long for normalization state");
+    }
+
+    std::ofstream output_file(output_path, std::ios::binary);
+    if (!output_file.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + output_path);
+    }
+
+    char date_bytes[kNormalizationDateBytes] = {};
+    state.last_date.copy(date_bytes, state.last_date.size());
+
+    output_file.write(reinterpret_cast<const char*>(&kNormalizationMagic), sizeof(uint32_t));
+    output_file.write(reinterpret_cast<const char*>(&kNormalizationVersion), sizeof(uint32_t));
+    output_file.write(reinterpret_cast<const char*>(&state.count), sizeof(uint64_t));
+    output_file.write(reinterpret_cast<const char*>(&state.mean), sizeof(double));
+    output_file.write(reinterpret_cast<const char*>(&state.m2), sizeof(double));
+    output_file.write(date_bytes, kNormalizationDateBytes);
+
+    if (!output_file.good()) {
+        throw std::runtime_error("Error writing to file: " + output_path);
+    }
+
+    output_file.close();
+}
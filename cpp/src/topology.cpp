@@ -3,13 +3,16 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <fstream>
 #include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#include <Eigen/Dense>
 #include <hera/wasserstein.h>
 
 // Embed CPU Ripser into this translation unit.
@@ -18,8 +21,9 @@
 #include "../third_party/ripser/ripser.cpp"
 #undef main
 
+template <typename Scalar>
 static void validate_square_matrix_size_or_throw(
-    const Matrix& matrix_values,
+    const MatrixT<Scalar>& matrix_values,
     uint32_t number_of_assets,
     const std::string& matrix_name
 ) {
@@ -42,9 +46,70 @@ static void validate_finite_or_throw(double value, const std::string& name) {
     }
 }
 
+/**
+ * @brief True if the scalar reference kernel was requested.
+ *
+ * Mirrors the kernel selection in graph.cpp: vectorized by default,
+ * MSI_SCALAR_KERNELS=1 restores the checked per-element loop.
+ */
+static bool use_scalar_kernel_path() {
+    const char* value = std::getenv("MSI_SCALAR_KERNELS");
+    return value != nullptr && value[0] == '1';
+}
+
 Matrix correlation_to_distance(
     const Matrix& correlation_matrix,
     uint32_t number_of_assets
+) {
+    Matrix distance_matrix;
+    correlation_to_distance_into(correlation_matrix, number_of_assets, distance_matrix);
+    return distance_matrix;
+}
+
+/**
+ * @brief Vectorized distance kernel, generic over the scalar type.
+ *
+ * Shared by the double path and the float32 compute mode; identical
+ * clamping to the scalar reference loop below.
+ */
+template <typename Scalar>
+static void correlation_to_distance_vectorized_into(
+    const MatrixT<Scalar>& correlation_matrix,
+    uint32_t number_of_assets,
+    MatrixT<Scalar>& out_distance_matrix
+) {
+    // One vectorized NaN/Inf scan instead of a branch per element.
+    Eigen::Map<const Eigen::Array<Scalar, Eigen::Dynamic, 1>> correlation_values(
+        correlation_matrix.data(),
+        static_cast<Eigen::Index>(correlation_matrix.size())
+    );
+    if (!correlation_values.isFinite().all()) {
+        throw std::runtime_error("correlation_matrix entry must be finite (not NaN/Inf)");
+    }
+
+    Eigen::Map<Eigen::Array<Scalar, Eigen::Dynamic, 1>> distance_values(
+        out_distance_matrix.data(),
+        static_cast<Eigen::Index>(out_distance_matrix.size())
+    );
+
+    // d_{ij} = sqrt(2 * (1 - corr)), with the same clamps as the
+    // scalar path: corr into [-1, 1], the sqrt argument at >= 0.
+    distance_values =
+        (Scalar(2) * (Scalar(1) - correlation_values.min(Scalar(1)).max(Scalar(-1))))
+            .max(Scalar(0)).sqrt();
+
+    for (uint32_t i = 0; i < number_of_assets; ++i) {
+        out_distance_matrix[
+            static_cast<size_t>(i) * static_cast<size_t>(number_of_assets) +
+            static_cast<size_t>(i)
+        ] = Scalar(0);
+    }
+}
+
+void correlation_to_distance_into(
+    const MatrixF& correlation_matrix,
+    uint32_t number_of_assets,
+    MatrixF& out_distance_matrix
 ) {
     validate_square_matrix_size_or_throw(
         correlation_matrix,
@@ -52,11 +117,38 @@ Matrix correlation_to_distance(
         "correlation_matrix"
     );
 
-    Matrix distance_matrix(
+    out_distance_matrix.assign(
+        static_cast<size_t>(number_of_assets) * static_cast<size_t>(number_of_assets),
+        0.0f
+    );
+
+    correlation_to_distance_vectorized_into(
+        correlation_matrix, number_of_assets, out_distance_matrix);
+}
+
+void correlation_to_distance_into(
+    const Matrix& correlation_matrix,
+    uint32_t number_of_assets,
+    Matrix& out_distance_matrix
+) {
+    validate_square_matrix_size_or_throw(
+        correlation_matrix,
+        number_of_assets,
+        "correlation_matrix"
+    );
+
+    Matrix& distance_matrix = out_distance_matrix;
+    distance_matrix.assign(
         static_cast<size_t>(number_of_assets) * static_cast<size_t>(number_of_assets),
         0.0
     );
 
+    if (!use_scalar_kernel_path()) {
+        correlation_to_distance_vectorized_into(
+            correlation_matrix, number_of_assets, distance_matrix);
+        return;
+    }
+
     for (uint32_t i = 0; i < number_of_assets; ++i) {
         for (uint32_t j = 0; j < number_of_assets; ++j) {
             const size_t flat_index =
@@ -86,15 +178,100 @@ Matrix correlation_to_distance(
             static_cast<size_t>(i)
         ] = 0.0;
     }
+}
+
+void correlation_to_distance_packed_into(
+    const PackedLowerMatrix& correlation_packed,
+    uint32_t number_of_assets,
+    PackedLowerMatrixF& out_distance_packed
+) {
+    const size_t expected_element_count = packed_lower_entry_count(number_of_assets);
+    if (correlation_packed.size() != expected_element_count) {
+        throw std::runtime_error(
+            "correlation_packed must have size N*(N-1)/2. Got size=" +
+            std::to_string(correlation_packed.size()) +
+            ", expected=" + std::to_string(expected_element_count) +
+            ", N=" + std::to_string(number_of_assets)
+        );
+    }
 
-    return distance_matrix;
+    Eigen::Map<const Eigen::ArrayXd> correlation_values(
+        correlation_packed.data(),
+        static_cast<Eigen::Index>(correlation_packed.size()));
+    if (!correlation_values.isFinite().all()) {
+        throw std::runtime_error("correlation_packed entry must be finite (not NaN/Inf)");
+    }
+
+    out_distance_packed.resize(correlation_packed.size());
+    Eigen::Map<Eigen::ArrayXf> distance_values(
+        out_distance_packed.data(),
+        static_cast<Eigen::Index>(out_distance_packed.size()));
+
+    // Same clamps as the dense kernel, then one narrowing cast into the
+    // float buffer Ripser will consume directly.
+    distance_values =
+        (2.0 * (1.0 - correlation_values.min(1.0).max(-1.0)))
+            .max(0.0).sqrt().cast<float>();
 }
 
 PersistenceDiagram compute_persistence_H1(
     const Matrix& distance_matrix,
     uint32_t number_of_assets
 ) {
+    // Default to the enclosing-radius cutoff; it leaves the finite H1
+    // diagram unchanged (see overload documentation).
+    return compute_persistence_H1(distance_matrix, number_of_assets, 0.0);
+}
+
+/**
+ * @brief Enclosing radius: min over points of the max distance to any
+ *        other point. Every homology class dies at or before it.
+ */
+template <typename Scalar>
+static double compute_enclosing_radius(
+    const MatrixT<Scalar>& distance_matrix,
+    uint32_t number_of_assets
+) {
+    double enclosing_radius = std::numeric_limits<double>::max();
+    for (uint32_t i = 0; i < number_of_assets; ++i) {
+        const Scalar* row =
+            distance_matrix.data() + static_cast<size_t>(i) * number_of_assets;
+        double row_maximum = 0.0;
+        for (uint32_t j = 0; j < number_of_assets; ++j) {
+            row_maximum = std::max(row_maximum, static_cast<double>(row[j]));
+        }
+        enclosing_radius = std::min(enclosing_radius, row_maximum);
+    }
+    return enclosing_radius;
+}
+
+static PersistenceDiagram run_embedded_ripser_H1(
+    std::vector<value_t> lower_triangle_distances,
+    value_t ripser_threshold,
+    uint32_t& out_open_interval_count
+);
+
+template <typename Scalar>
+static PersistenceDiagram compute_persistence_H1_impl(
+    const MatrixT<Scalar>& distance_matrix,
+    uint32_t number_of_assets,
+    double distance_threshold,
+    uint32_t& out_open_interval_count
+) {
+    out_open_interval_count = 0;
     validate_square_matrix_size_or_throw(distance_matrix, number_of_assets, "distance_matrix");
+    validate_finite_or_throw(distance_threshold, "distance_threshold");
+
+    value_t ripser_threshold = std::numeric_limits<value_t>::max();
+    if (distance_threshold == 0.0) {
+        if (number_of_assets > 1) {
+            ripser_threshold = static_cast<value_t>(
+                compute_enclosing_radius(distance_matrix, number_of_assets)
+            );
+        }
+    } else if (distance_threshold > 0.0) {
+        ripser_threshold = static_cast<value_t>(distance_threshold);
+    }
 
     const size_t number_of_points = static_cast<size_t>(number_of_assets);
     const size_t number_of_lower_triangle_entries =
@@ -109,7 +286,7 @@ PersistenceDiagram compute_persistence_H1(
                 static_cast<size_t>(i) * static_cast<size_t>(number_of_assets) +
                 static_cast<size_t>(j);
 
-            const double distance_value = distance_matrix[flat_index];
+            const double distance_value = static_cast<double>(distance_matrix[flat_index]);
             validate_finite_or_throw(distance_value, "distance_matrix entry");
             if (distance_value < 0.0) {
                 throw std::runtime_error("distance_matrix must be non-negative");
@@ -119,6 +296,23 @@ PersistenceDiagram compute_persistence_H1(
         }
     }
 
+    return run_embedded_ripser_H1(
+        std::move(lower_triangle_distances), ripser_threshold, out_open_interval_count);
+}
+
+/**
+ * @brief Invoke the embedded Ripser on a lower-triangle distance buffer
+ *        and parse the dim-1 barcode from its captured output.
+ *
+ * The buffer is consumed by move; its layout is Ripser's own
+ * lower-distance-matrix order (strictly-lower triangle, row-major).
+ */
+static PersistenceDiagram run_embedded_ripser_H1(
+    std::vector<value_t> lower_triangle_distances,
+    value_t ripser_threshold,
+    uint32_t& out_open_interval_count
+) {
+    out_open_interval_count = 0;
     compressed_lower_distance_matrix ripser_distance_matrix(std::move(lower_triangle_distances));
 
     std::ostringstream captured_output;
@@ -126,14 +320,13 @@ PersistenceDiagram compute_persistence_H1(
 
     try {
         const index_t dim_max = 1;
-        const value_t threshold = std::numeric_limits<value_t>::max();
         const float ratio = 0.0f;
         const coefficient_t modulus = 2;
 
         ripser<compressed_lower_distance_matrix>(
             std::move(ripser_distance_matrix),
             dim_max,
-            threshold,
+            ripser_threshold,
             ratio,
             modulus
         ).compute_barcodes();
@@ -191,7 +384,10 @@ PersistenceDiagram compute_persistence_H1(
             continue;
         }
         if (death_text.empty()) {
-            // Ignore infinite intervals for now.
+            // Open interval: the class was still alive at the cutoff.
+            // Not part of the finite diagram, but the warm-start path
+            // uses the count to detect a clipped filtration.
+            out_open_interval_count += 1;
             continue;
         }
 
@@ -210,6 +406,173 @@ PersistenceDiagram compute_persistence_H1(
     return diagram;
 }
 
+PersistenceDiagram compute_persistence_H1(
+    const Matrix& distance_matrix,
+    uint32_t number_of_assets,
+    double distance_threshold
+) {
+    uint32_t open_interval_count = 0;
+    return compute_persistence_H1_impl(
+        distance_matrix, number_of_assets, distance_threshold, open_interval_count);
+}
+
+PersistenceDiagram compute_persistence_H1(
+    const MatrixF& distance_matrix,
+    uint32_t number_of_assets,
+    double distance_threshold
+) {
+    uint32_t open_interval_count = 0;
+    return compute_persistence_H1_impl(
+        distance_matrix, number_of_assets, distance_threshold, open_interval_count);
+}
+
+PersistenceDiagram compute_persistence_H1_packed(
+    PackedLowerMatrixF distance_packed,
+    uint32_t number_of_assets,
+    double distance_threshold
+) {
+    const size_t expected_element_count = packed_lower_entry_count(number_of_assets);
+    if (distance_packed.size() != expected_element_count) {
+        throw std::runtime_error(
+            "distance_packed must have size N*(N-1)/2. Got size=" +
+            std::to_string(distance_packed.size()) +
+            ", expected=" + std::to_string(expected_element_count) +
+            ", N=" + std::to_string(number_of_assets)
+        );
+    }
+    validate_finite_or_throw(distance_threshold, "distance_threshold");
+
+    {
+        Eigen::Map<const Eigen::ArrayXf> distance_values(
+            distance_packed.data(),
+            static_cast<Eigen::Index>(distance_packed.size()));
+        if (!distance_values.isFinite().all()) {
+            throw std::runtime_error("distance_packed entry must be finite (not NaN/Inf)");
+        }
+        if (!(distance_values >= 0.0f).all()) {
+            throw std::runtime_error("distance_packed must be non-negative");
+        }
+    }
+
+    value_t ripser_threshold = std::numeric_limits<value_t>::max();
+    if (distance_threshold == 0.0) {
+        if (number_of_assets > 1) {
+            // Enclosing radius from packed storage: each stored (i, j)
+            // entry feeds both endpoint row maxima.
+            std::vector<double> row_maxima(number_of_assets, 0.0);
+            size_t packed_index = 0;
+            for (uint32_t i = 1; i < number_of_assets; ++i) {
+                for (uint32_t j = 0; j < i; ++j) {
+                    const double distance_value =
+                        static_cast<double>(distance_packed[packed_index++]);
+                    row_maxima[i] = std::max(row_maxima[i], distance_value);
+                    row_maxima[j] = std::max(row_maxima[j], distance_value);
+                }
+            }
+            double enclosing_radius = std::numeric_limits<double>::max();
+            for (uint32_t i = 0; i < number_of_assets; ++i) {
+                enclosing_radius = std::min(enclosing_radius, row_maxima[i]);
+            }
+            ripser_threshold = static_cast<value_t>(enclosing_radius);
+        }
+    } else if (distance_threshold > 0.0) {
+        ripser_threshold = static_cast<value_t>(distance_threshold);
+    }
+
+    // The packed layout is Ripser's own lower-distance-matrix order, so
+    // when value_t is float (the embedded build) the buffer moves in
+    // with no copy; a double-valued Ripser would force one widening.
+    std::vector<value_t> lower_triangle_distances;
+    if constexpr (std::is_same<value_t, float>::value) {
+        lower_triangle_distances = std::move(distance_packed);
+    } else {
+        lower_triangle_distances.assign(distance_packed.begin(), distance_packed.end());
+    }
+
+    uint32_t open_interval_count = 0;
+    return run_embedded_ripser_H1(
+        std::move(lower_triangle_distances), ripser_threshold, open_interval_count);
+}
+
+/**
+ * @brief Warm-started persistence, generic over the scalar type.
+ *
+ * Cap the filtration just above the previous day's maximum death, run
+ * the (much cheaper) capped reduction, and fall back to the full
+ * enclosing-radius run if any class was still alive at the cap. See
+ * the header for the exactness discussion.
+ */
+template <typename Scalar>
+static PersistenceDiagram compute_persistence_H1_warm_start_impl(
+    const MatrixT<Scalar>& distance_matrix,
+    uint32_t number_of_assets,
+    const PersistenceDiagram& previous_diagram,
+    double threshold_margin
+) {
+    validate_finite_or_throw(threshold_margin, "threshold_margin");
+    if (threshold_margin < 0.0) {
+        throw std::runtime_error("threshold_margin must be >= 0");
+    }
+
+    if (previous_diagram.empty() || number_of_assets < 2) {
+        uint32_t open_interval_count = 0;
+        return compute_persistence_H1_impl(
+            distance_matrix, number_of_assets, 0.0, open_interval_count);
+    }
+
+    double previous_maximum_death = 0.0;
+    for (const PersistencePair& pair : previous_diagram) {
+        validate_finite_or_throw(pair.death, "previous_diagram.death");
+        previous_maximum_death = std::max(previous_maximum_death, pair.death);
+    }
+
+    const double warm_threshold = previous_maximum_death * (1.0 + threshold_margin);
+    const double enclosing_radius =
+        compute_enclosing_radius(distance_matrix, number_of_assets);
+
+    // No headroom below the enclosing radius: the capped run would cost
+    // the same as the exact default, so just run it.
+    if (warm_threshold <= 0.0 || warm_threshold >= enclosing_radius) {
+        uint32_t open_interval_count = 0;
+        return compute_persistence_H1_impl(
+            distance_matrix, number_of_assets, 0.0, open_interval_count);
+    }
+
+    uint32_t open_interval_count = 0;
+    PersistenceDiagram diagram = compute_persistence_H1_impl(
+        distance_matrix, number_of_assets, warm_threshold, open_interval_count);
+
+    // A class alive at the cap means the diagram drifted past the
+    // margin; recover exactness with the full run.
+    if (open_interval_count > 0) {
+        uint32_t fallback_open_interval_count = 0;
+        diagram = compute_persistence_H1_impl(
+            distance_matrix, number_of_assets, 0.0, fallback_open_interval_count);
+    }
+
+    return diagram;
+}
+
+PersistenceDiagram compute_persistence_H1_warm_start(
+    const Matrix& distance_matrix,
+    uint32_t number_of_assets,
+    const PersistenceDiagram& previous_diagram,
+    double threshold_margin
+) {
+    return compute_persistence_H1_warm_start_impl(
+        distance_matrix, number_of_assets, previous_diagram, threshold_margin);
+}
+
+PersistenceDiagram compute_persistence_H1_warm_start(
+    const MatrixF& distance_matrix,
+    uint32_t number_of_assets,
+    const PersistenceDiagram& previous_diagram,
+    double threshold_margin
+) {
+    return compute_persistence_H1_warm_start_impl(
+        distance_matrix, number_of_assets, previous_diagram, threshold_margin);
+}
+
 double compute_total_persistence(const PersistenceDiagram& diagram) {
     double total_persistence = 0.0;
 
@@ -296,37 +659,67 @@ PersistenceDiagram load_diagram_bin(const std::string& input_path) {
     return diagram;
 }
 
-double compute_wasserstein_distance(
-    const PersistenceDiagram& current_diagram,
-    const PersistenceDiagram& previous_diagram
+/**
+ * @brief Validate a diagram and collect its pairs, dropping pairs with
+ *        lifetime below the epsilon cutoff.
+ */
+static std::vector<std::pair<double, double>> collect_pairs_above_epsilon(
+    const PersistenceDiagram& diagram,
+    double lifetime_epsilon,
+    const std::string& diagram_name
 ) {
-    std::vector<std::pair<double, double>> current_pairs;
-    current_pairs.reserve(current_diagram.size());
+    std::vector<std::pair<double, double>> pairs;
+    pairs.reserve(diagram.size());
 
-    for (const PersistencePair& pair : current_diagram) {
-        validate_finite_or_throw(pair.birth, "current_diagram.birth");
-        validate_finite_or_throw(pair.death, "current_diagram.death");
+    for (const PersistencePair& pair : diagram) {
+        validate_finite_or_throw(pair.birth, diagram_name + ".birth");
+        validate_finite_or_throw(pair.death, diagram_name + ".death");
         if (pair.death < pair.birth) {
-            throw std::runtime_error("current_diagram contains a pair with death < birth");
+            throw std::runtime_error(diagram_name + " contains a pair with death < birth");
         }
-        current_pairs.emplace_back(pair.birth, pair.death);
+        if (pair.death - pair.birth < lifetime_epsilon) {
+            continue;
+        }
+        pairs.emplace_back(pair.birth, pair.death);
     }
 
-    std::vector<std::pair<double, double>> previous_pairs;
-    previous_pairs.reserve(previous_diagram.size());
+    return pairs;
+}
 
-    for (const PersistencePair& pair : previous_diagram) {
-        validate_finite_or_throw(pair.birth, "previous_diagram.birth");
-        validate_finite_or_throw(pair.death, "previous_diagram.death");
-        if (pair.death < pair.birth) {
-            throw std::runtime_error("previous_diagram contains a pair with death < birth");
-        }
-        previous_pairs.emplace_back(pair.birth, pair.death);
+double compute_wasserstein_distance(
+    const PersistenceDiagram& current_diagram,
+    const PersistenceDiagram& previous_diagram
+) {
+    // Exact matching: no pruning, hera's default auction precision.
+    return compute_wasserstein_distance(current_diagram, previous_diagram, 0.0, 0.0);
+}
+
+double compute_wasserstein_distance(
+    const PersistenceDiagram& current_diagram,
+    const PersistenceDiagram& previous_diagram,
+    double lifetime_epsilon,
+    double relative_error_delta
+) {
+    validate_finite_or_throw(lifetime_epsilon, "lifetime_epsilon");
+    validate_finite_or_throw(relative_error_delta, "relative_error_delta");
+    if (lifetime_epsilon < 0.0) {
+        throw std::runtime_error("lifetime_epsilon must be >= 0");
+    }
+    if (relative_error_delta < 0.0) {
+        throw std::runtime_error("relative_error_delta must be >= 0");
     }
 
+    std::vector<std::pair<double, double>> current_pairs =
+        collect_pairs_above_epsilon(current_diagram, lifetime_epsilon, "current_diagram");
+    std::vector<std::pair<double, double>> previous_pairs =
+        collect_pairs_above_epsilon(previous_diagram, lifetime_epsilon, "previous_diagram");
+
     hera::AuctionParams<double> params;
     params.wasserstein_power = 1.0;
     params.internal_p = 2.0;
+    if (relative_error_delta > 0.0) {
+        params.delta = relative_error_delta;
+    }
 
     const double distance_value = hera::wasserstein_dist(current_pairs, previous_pairs, params);
     validate_finite_or_throw(distance_value, "wasserstein_distance");